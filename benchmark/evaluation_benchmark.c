@@ -0,0 +1,232 @@
+/*
+Benchmark for "scan_world".
+Times "scan_world" against "scan_world_before", a copy of the loop as it was before the cargo totals used by "evaluate_dump" were worked out once per scan instead of once per dump.
+Builds a random world and runs both on the same scans for every combination of another bot on the map, the cannot-afford-petrol scan and few turns left. Both must find the same best value, distance and quantity.
+
+Compile from the directory above with:
+    gcc -O2 -I. -o evaluation_benchmark benchmark/evaluation_benchmark.c trader_bot.c evaluations.c fuel.c "miscellaneous .c" buyer_index.c world_snapshot.c rollouts.c tour_planner.c what_if.c -pthread
+Usage:
+    ./evaluation_benchmark [number of locations] [scans per case]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "trader_bot.h"
+#include "trader_header.h"
+
+#define DEFAULT_LOCATIONS 1000
+#define DEFAULT_SCANS 20
+#define N_COMMODITIES 8
+#define N_CASES 8
+
+typedef void (*scan_function)(struct bot *b, struct buyer_index *index, struct location *start, int *best_value, 
+    int *distance_to_best_value, int *best_value_quantity, int cannot_afford_petrol);
+
+
+static const char *const case_names[N_CASES] = {
+    "single normal mid",
+    "single normal end",
+    "single no-petrol mid",
+    "single no-petrol end",
+    "contended normal mid",
+    "contended normal end",
+    "contended no-petrol mid",
+    "contended no-petrol end",
+};
+
+
+//"scan_world" as it was before the cargo totals were hoisted: "buyer_total_for_cargo" walks the whole map again for every dump evaluated.
+static void scan_world_before(struct bot *b, struct buyer_index *index, struct location *start, int *best_value, int *distance_to_best_value, 
+    int *best_value_quantity, int cannot_afford_petrol) {
+
+    struct location *forwards = start;
+    struct location *backwards = start;
+    int distance = 0;
+    int value = 0;
+    int transaction_quantity = 0;
+
+    while (distance < 2 || (backwards != forwards->previous && backwards != forwards->previous->previous)) {
+        if (forwards->type == LOCATION_BUYER) {
+            value = evaluate_buyer(b, forwards, distance, cannot_afford_petrol);
+            if (value > *best_value) {
+                *best_value = value; 
+                *distance_to_best_value = distance;
+            }
+        } else if (forwards->type == LOCATION_SELLER && b->turns_left >= MIN_TURNS_TO_BUY_AND_SELL) {
+            value = evaluate_seller(b, index, forwards, distance % index->map_size, distance, *best_value, &transaction_quantity);
+            if (value > *best_value) { 
+                *best_value = value; 
+                *best_value_quantity = transaction_quantity; 
+                *distance_to_best_value = distance;
+            }
+        } else if (forwards->type == LOCATION_DUMP && b->turns_left >= MIN_TURNS_TO_ACTION_THEN_MAKE_PROFIT) {
+            value = evaluate_dump(b, forwards, distance, cannot_afford_petrol, buyer_total_for_cargo(b), cargo_quantity_total(b->cargo));
+            if (value > *best_value) { 
+                *best_value = value; 
+                *best_value_quantity = transaction_quantity;
+                *distance_to_best_value = distance;
+            }
+        }
+
+        if (backwards->type == LOCATION_BUYER) {
+            value = evaluate_buyer(b, backwards, distance, cannot_afford_petrol);
+            if (value > *best_value) { 
+                *best_value = value; 
+                *distance_to_best_value = -distance;
+            }
+        } else if (backwards->type == LOCATION_SELLER && b->turns_left >= MIN_TURNS_TO_BUY_AND_SELL) {
+            value = evaluate_seller(b, index, backwards, (index->map_size - distance) % index->map_size, distance, *best_value, &transaction_quantity);
+            if (value > *best_value) { 
+                *best_value = value; 
+                *best_value_quantity = transaction_quantity; 
+                *distance_to_best_value = -distance;
+            }
+        } else if (backwards->type == LOCATION_DUMP && b->turns_left >= MIN_TURNS_TO_ACTION_THEN_MAKE_PROFIT) {
+            value = evaluate_dump(b, backwards, distance, cannot_afford_petrol, buyer_total_for_cargo(b), cargo_quantity_total(b->cargo));
+            if (value > *best_value) { 
+                *best_value = value; 
+                *best_value_quantity = transaction_quantity; 
+                *distance_to_best_value = -distance;
+            }
+        }
+
+        forwards = forwards->next;
+        backwards = backwards->previous;
+        distance++;
+    }
+}
+
+
+static double seconds_now(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+//Runs one scan and returns how long it took in microseconds.
+static double time_scan(scan_function scan, struct bot *b, struct buyer_index *index, int cannot_afford_petrol,
+    int *best_value, int *distance_to_best_value, int *best_value_quantity) {
+
+    double start = seconds_now();
+
+    *best_value = 0;
+    *distance_to_best_value = 0;
+    *best_value_quantity = 0;
+    scan(b, index, b->location, best_value, distance_to_best_value, best_value_quantity, cannot_afford_petrol);
+    return (seconds_now() - start) * 1e6;
+}
+
+
+int main(int argc, char *argv[]) {
+    int n_locations = argc > 1 ? atoi(argv[1]) : DEFAULT_LOCATIONS;
+    int scans = argc > 2 ? atoi(argv[2]) : DEFAULT_SCANS;
+    struct commodity commodities[N_COMMODITIES];
+    char names[N_COMMODITIES][16];
+    struct location *locations = calloc(n_locations, sizeof (struct location));
+    struct cargo cargo[2];
+    struct bot me = {0};
+    struct bot other = {0};
+    struct bot_list me_on_location = {&me, NULL};
+    struct bot_list other_on_location = {&other, NULL};
+
+    assert(n_locations >= 4 && scans > 0 && locations != NULL);
+    srand(1);
+
+    for (int counter = 0; counter < N_COMMODITIES; counter++) {
+        snprintf(names[counter], sizeof names[counter], "commodity %d", counter);
+        commodities[counter].name = names[counter];
+        commodities[counter].weight = 1 + rand() % 5;
+        commodities[counter].volume = 1 + rand() % 5;
+    }
+
+    for (int counter = 0; counter < n_locations; counter++) {    //roughly 4 sellers and 4 buyers for every petrol station and dump
+        struct location *location = &locations[counter];
+        int kind = rand() % 10;
+
+        location->name = "location";
+        location->next = &locations[(counter + 1) % n_locations];
+        location->previous = &locations[(counter + n_locations - 1) % n_locations];
+        if (counter == 0) {
+            location->type = LOCATION_START;
+        } else if (kind < 4) {
+            location->type = LOCATION_SELLER;
+            location->commodity = &commodities[rand() % N_COMMODITIES];
+            location->price = 10 + rand() % 50;
+            location->quantity = 10 + rand() % 100;
+        } else if (kind < 8) {
+            location->type = LOCATION_BUYER;
+            location->commodity = &commodities[rand() % N_COMMODITIES];
+            location->price = 30 + rand() % 80;
+            location->quantity = 10 + rand() % 100;
+        } else if (kind < 9) {
+            location->type = LOCATION_PETROL_STATION;
+            location->price = 2 + rand() % 5;
+            location->quantity = 50 + rand() % 200;
+        } else {
+            location->type = LOCATION_DUMP;
+        }
+    }
+
+    cargo[0].commodity = &commodities[0];     //a little cargo so that buyers and dumps have something to evaluate
+    cargo[0].quantity = 20;
+    cargo[0].next = &cargo[1];
+    cargo[1].commodity = &commodities[1];
+    cargo[1].quantity = 10;
+    cargo[1].next = NULL;
+
+    me.name = "benchmark";
+    me.location = &locations[0];
+    me.cash = 2000;
+    me.fuel = 60;
+    me.fuel_tank_capacity = 60;
+    me.maximum_move = 7;
+    me.maximum_cargo_weight = 200;
+    me.maximum_cargo_volume = 200;
+    me.cargo = cargo;
+    other = me;
+    other.name = "opponent";
+    locations[0].bots = &me_on_location;
+
+    printf("%d locations, %d scans per case\n", n_locations, scans);
+    printf("%-26s %12s %12s %8s\n", "case", "before us", "after us", "speedup");
+
+    for (int test_case = 0; test_case < N_CASES; test_case++) {
+        int contended = test_case & 4;
+        int cannot_afford_petrol = (test_case & 2) ? TRUE : FALSE;
+
+        locations[n_locations / 3].bots = contended ? &other_on_location : NULL;
+        me.turns_left = (test_case & 1) ? MIN_TURNS_TO_ACTION_THEN_MAKE_PROFIT - 1 : 50;
+
+        struct buyer_index *index = build_buyer_index(&me);
+
+        int before_value, before_distance, before_quantity;
+        int after_value, after_distance, after_quantity;
+        double before_time = 0;
+        double after_time = 0;
+
+        time_scan(scan_world_before, &me, index, cannot_afford_petrol, &before_value, &before_distance, &before_quantity);   //warm up
+        for (int counter = 0; counter < scans; counter++) {      //the two are interleaved so neither is favoured by the state of the cache
+            before_time += time_scan(scan_world_before, &me, index, cannot_afford_petrol, &before_value, &before_distance, &before_quantity);
+            after_time += time_scan(scan_world, &me, index, cannot_afford_petrol, &after_value, &after_distance, &after_quantity);
+        }
+        before_time /= scans;
+        after_time /= scans;
+
+        if (before_value != after_value || before_distance != after_distance || before_quantity != after_quantity) {
+            printf("%s: scan_world found %d at %d (quantity %d), scan_world_before found %d at %d (quantity %d)\n", case_names[test_case], 
+                after_value, after_distance, after_quantity, before_value, before_distance, before_quantity);
+            return 1;
+        }
+        printf("%-26s %12.1f %12.1f %7.2fx\n", case_names[test_case], before_time, after_time, before_time / after_time);
+
+        free_buyer_index(index);
+    }
+
+    free(locations);
+    return 0;
+}
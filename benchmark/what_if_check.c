@@ -0,0 +1,151 @@
+/*
+Equivalence check for the "what if" evaluations in "what_if.c".
+Builds random worlds with several bots on them (some sharing a location, some buyers wanting fewer units than there are bots on them) and, for every bot, compares what "scan_world" finds with what
+"what_if_best_value" finds for that bot's state in a snapshot built for the first bot: the same best value, at the same location, with the same quantity when it is a seller.
+Prints the first mismatch and exits with 1, otherwise prints the number of comparisons made.
+
+Compile from the directory above with:
+    gcc -O2 -I. -o what_if_check benchmark/what_if_check.c trader_bot.c evaluations.c fuel.c "miscellaneous .c" buyer_index.c world_snapshot.c rollouts.c tour_planner.c what_if.c -pthread
+Usage:
+    ./what_if_check [number of worlds] [seed]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "trader_bot.h"
+#include "trader_header.h"
+
+#define DEFAULT_WORLDS 5000
+#define N_COMMODITIES 8
+#define MAX_BOTS 5
+#define MAX_LOCATIONS 200
+
+
+//Fills "locations" with a random ring of "n_locations" locations, roughly 4 sellers and 4 buyers for every petrol station and dump.
+static void random_world(struct location *locations, int n_locations, struct commodity *commodities) {
+    for (int counter = 0; counter < n_locations; counter++) {
+        struct location *location = &locations[counter];
+        int kind = rand() % 10;
+
+        memset(location, 0, sizeof (struct location));
+        location->name = "location";
+        location->next = &locations[(counter + 1) % n_locations];
+        location->previous = &locations[(counter + n_locations - 1) % n_locations];
+        if (counter == 0) {
+            location->type = LOCATION_START;
+        } else if (kind < 4) {
+            location->type = LOCATION_SELLER;
+            location->commodity = &commodities[rand() % N_COMMODITIES];
+            location->price = 10 + rand() % 50;
+            location->quantity = rand() % 110;
+        } else if (kind < 8) {
+            location->type = LOCATION_BUYER;
+            location->commodity = &commodities[rand() % N_COMMODITIES];
+            location->price = 30 + rand() % 80;
+            location->quantity = rand() % 4 == 0 ? 1 + rand() % 3 : 10 + rand() % 100;    //a few buyers small enough for the bots on them to matter
+        } else if (kind < 9) {
+            location->type = LOCATION_PETROL_STATION;
+            location->price = 2 + rand() % 5;
+            location->quantity = rand() % 250;
+        } else {
+            location->type = LOCATION_DUMP;
+        }
+    }
+}
+
+
+//Gives a bot a random location (often the same as the bot before it), fuel, cash and up to 2 commodities of cargo.
+static void random_bot(struct bot *bot, struct bot *previous, struct location *locations, int n_locations, struct commodity *commodities, struct cargo cargo[2], int turns_left) {
+    memset(bot, 0, sizeof (struct bot));
+    bot->name = "bot";
+    bot->location = previous != NULL && rand() % 3 == 0 ? previous->location : &locations[rand() % n_locations];
+    bot->cash = rand() % 3000;
+    bot->fuel = 1 + rand() % 60;
+    bot->fuel_tank_capacity = 60;
+    bot->maximum_move = 7;
+    bot->maximum_cargo_weight = 200;
+    bot->maximum_cargo_volume = 200;
+    bot->turns_left = turns_left;
+
+    int first_commodity = rand() % N_COMMODITIES;
+    int n_cargo = rand() % 3;
+    for (int counter = 0; counter < n_cargo; counter++) {
+        cargo[counter].commodity = &commodities[(first_commodity + counter) % N_COMMODITIES];
+        cargo[counter].quantity = 1 + rand() % 30;
+        cargo[counter].next = counter + 1 < n_cargo ? &cargo[counter + 1] : NULL;
+    }
+    bot->cargo = n_cargo > 0 ? &cargo[0] : NULL;
+}
+
+
+int main(int argc, char *argv[]) {
+    int n_worlds = argc > 1 ? atoi(argv[1]) : DEFAULT_WORLDS;
+    struct commodity commodities[N_COMMODITIES];
+    char names[N_COMMODITIES][16];
+    struct location locations[MAX_LOCATIONS];
+    struct bot bots[MAX_BOTS];
+    struct bot_list bot_lists[MAX_BOTS];
+    struct cargo cargo[MAX_BOTS][2];
+    int comparisons = 0;
+
+    srand(argc > 2 ? atoi(argv[2]) : 1);
+
+    for (int counter = 0; counter < N_COMMODITIES; counter++) {
+        snprintf(names[counter], sizeof names[counter], "commodity %d", counter);
+        commodities[counter].name = names[counter];
+        commodities[counter].weight = 1 + rand() % 5;
+        commodities[counter].volume = 1 + rand() % 5;
+    }
+
+    for (int world_counter = 0; world_counter < n_worlds; world_counter++) {
+        int n_locations = 10 + rand() % (MAX_LOCATIONS - 10);
+        int n_bots = 1 + rand() % MAX_BOTS;
+        int turns_left = 1 + rand() % 50;
+
+        random_world(locations, n_locations, commodities);
+        for (int counter = 0; counter < n_bots; counter++) {
+            random_bot(&bots[counter], counter > 0 ? &bots[counter - 1] : NULL, locations, n_locations, commodities, cargo[counter], turns_left);
+            bot_lists[counter].bot = &bots[counter];
+            bot_lists[counter].next = bots[counter].location->bots;
+            bots[counter].location->bots = &bot_lists[counter];
+        }
+
+        struct world_snapshot *world = build_world_snapshot(&bots[0]);
+        assert(world != NULL);
+
+        int snapshot_bot = 1;                       //the other bots are numbered in the snapshot in the order they are met going forwards from the first bot
+        struct location *current = bots[0].location;
+        for (int position = 0; position < n_locations; position++) {
+            for (struct bot_list *bot_list = current->bots; bot_list != NULL; bot_list = bot_list->next) {
+                int bot = bot_list->bot - bots;
+                int snapshot_index = bot == 0 ? 0 : snapshot_bot++;
+                struct buyer_index *index = build_buyer_index(&bots[bot]);
+                struct hypothetical_state state;
+                int best_value = 0, distance_to_best_value = 0, best_value_quantity = 0;
+                int what_if_position, what_if_quantity;
+
+                scan_world(&bots[bot], index, bots[bot].location, &best_value, &distance_to_best_value, &best_value_quantity, FALSE);
+                hypothetical_state_of_bot(world, snapshot_index, &state);
+                int what_if = what_if_best_value(world, &state, &what_if_position, &what_if_quantity);
+                int expected_position = ((position + distance_to_best_value) % n_locations + n_locations) % n_locations;
+
+                if (what_if != best_value || what_if_position != expected_position ||
+                    (world->locations[what_if_position].type == LOCATION_SELLER && what_if_quantity != best_value_quantity)) {
+                    printf("world %d, bot %d: scan_world found %d at %d (quantity %d), what_if_best_value found %d at %d (quantity %d)\n", world_counter, bot,
+                        best_value, expected_position, best_value_quantity, what_if, what_if_position, what_if_quantity);
+                    return 1;
+                }
+                comparisons++;
+                free_buyer_index(index);
+            }
+            current = current->next;
+        }
+
+        free_world_snapshot(world);
+    }
+
+    printf("%d worlds, %d comparisons, no mismatches\n", n_worlds, comparisons);
+    return 0;
+}
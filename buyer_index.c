@@ -0,0 +1,108 @@
+/*
+This file contains the per-turn index of buyers used to prune seller evaluations in "scan_world".
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "trader_bot.h"
+#include "trader_header.h"
+
+//qsort comparison for "build_buyer_index": groups buyers by commodity name and then orders each group from highest to lowest price.
+static int compare_indexed_buyers(const void *first, const void *second) {
+    const struct indexed_buyer *buyer_a = first;
+    const struct indexed_buyer *buyer_b = second;
+    int same_commodity = strcmp(buyer_a->location->commodity->name, buyer_b->location->commodity->name);
+
+    if (same_commodity != 0) {
+        return same_commodity;
+    }
+    if (buyer_a->location->price != buyer_b->location->price) {
+        return buyer_b->location->price - buyer_a->location->price;
+    }
+    return buyer_a->position - buyer_b->position;   //ties are kept in map order so the result does not depend on the qsort implementation
+}
+
+
+//Builds the buyer index for this turn. Every buyer on the map is recorded with its position (distance forwards from the bot's current location) and buyers are grouped by commodity, sorted from highest to lowest price.
+//Since each group knows its highest price, an evaluation can compute the best margin a seller could ever make before looking at a single buyer.
+struct buyer_index *build_buyer_index(struct bot *b) {
+    struct buyer_index *index = malloc(sizeof (struct buyer_index));
+    struct location *current = b->location;
+    int n_buyers = 0;
+    int position = 0;
+
+    assert(index != NULL);
+    index->map_size = size_of_map(b);
+    index->n_other_bots = 0;
+
+    do {                                        //first lap counts the buyers so the arrays can be allocated in one go, and the other bots while it is at it
+        if (current->type == LOCATION_BUYER) {
+            n_buyers++;
+        }
+        for (struct bot_list *bots = current->bots; bots != NULL; bots = bots->next) {
+            if (bots->bot != b) {
+                index->n_other_bots++;
+            }
+        }
+        current = current->next;
+    } while (current != b->location);
+
+    index->buyers = malloc((n_buyers + 1) * sizeof (struct indexed_buyer));
+    index->commodities = malloc((n_buyers + 1) * sizeof (struct commodity_buyers));   //there can never be more commodity groups than buyers
+    index->n_buyers = n_buyers;
+    index->n_commodities = 0;
+    assert(index->buyers != NULL && index->commodities != NULL);
+
+    n_buyers = 0;
+    do {                                        //second lap records each buyer and its position
+        if (current->type == LOCATION_BUYER) {
+            index->buyers[n_buyers].location = current;
+            index->buyers[n_buyers].position = position;
+            n_buyers++;
+        }
+        current = current->next;
+        position++;
+    } while (current != b->location);
+
+    qsort(index->buyers, index->n_buyers, sizeof (struct indexed_buyer), compare_indexed_buyers);
+
+    for (int counter = 0; counter < index->n_buyers; counter++) {   //as the buyers are now sorted, each commodity is a contiguous run whose first buyer holds the maximum price
+        struct location *buyer = index->buyers[counter].location;
+        struct commodity_buyers *group = &index->commodities[index->n_commodities];
+
+        if (index->n_commodities > 0 && strcmp(group[-1].commodity->name, buyer->commodity->name) == 0) {
+            group = &group[-1];
+        } else {
+            group->commodity = buyer->commodity;
+            group->max_price = buyer->price;
+            group->first_buyer = counter;
+            group->n_buyers = 0;
+            index->n_commodities++;
+        }
+        group->n_buyers++;
+    }
+
+    return index;
+}
+
+
+//Returns the group of buyers for a given commodity, or NULL if no buyer on the map wants it.
+struct commodity_buyers *buyers_for_commodity(struct buyer_index *index, struct commodity *commodity) {
+    for (int counter = 0; counter < index->n_commodities; counter++) {
+        if (index->commodities[counter].commodity == commodity ||
+            strcmp(index->commodities[counter].commodity->name, commodity->name) == 0) {
+            return &index->commodities[counter];
+        }
+    }
+    return NULL;
+}
+
+
+//Frees the index once "get_action" has made its decision for the turn.
+void free_buyer_index(struct buyer_index *index) {
+    free(index->buyers);
+    free(index->commodities);
+    free(index);
+}
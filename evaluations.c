@@ -16,7 +16,7 @@ This file contains all evaluating functions called in "scan world"
 int evaluate_buyer(struct bot *b, struct location *buyer, int distance_from_current, int cannot_afford_petrol) {
     struct cargo *current = b->cargo;
 
-    if(bots_on_location(buyer) >= buyer->quantity && distance_from_current == 0) {  //Ensures that the bot does not fail to sell to the buyer due to too many players trying to do the same all at once. 
+    if (distance_from_current == 0 && bots_on_location(buyer) >= buyer->quantity) {  //Ensures that the bot does not fail to sell to the buyer due to too many players trying to do the same all at once. The bot list is only walked for the buyer the bot is on.
         return 0;
     }
 
@@ -52,7 +52,9 @@ int evaluate_buyer(struct bot *b, struct location *buyer, int distance_from_curr
 
 
 //Determines the value of a seller as the margin made if the bot was to sell their commodity to the nearest buyer.
-int evaluate_seller(struct bot *b, struct location *seller, int distance_from_current, int *transaction_quantity) {
+//"best_value" is the best value found so far in "scan_world". If even the highest priced buyer in the index could not beat it, the seller is skipped without evaluating any buyers.
+int evaluate_seller(struct bot *b, struct buyer_index *index, struct location *seller, int seller_position, int distance_from_current, 
+    int best_value, int *transaction_quantity) {
     int max_transportable_weight = b->maximum_cargo_weight;
     int max_transportable_volume = b->maximum_cargo_volume;
 
@@ -74,7 +76,12 @@ int evaluate_seller(struct bot *b, struct location *seller, int distance_from_cu
         *transaction_quantity = seller->quantity;
     }
 
-    int seller_value = get_best_value_for_seller(b, seller, distance_from_current, &transaction_quantity);  //the rest of the evaluation is done in finding the most valuable buyer for this seller.
+    struct commodity_buyers *buyers = buyers_for_commodity(index, seller->commodity);
+    if (buyers == NULL || (buyers->max_price - seller->price) * *transaction_quantity <= best_value) {    //margin * quantity ignores travel cost so it is an upper bound on the seller's value. If it cannot beat "best_value" there is no point looking at its buyers.
+        return 0;
+    }
+
+    int seller_value = get_best_value_for_seller(b, index, seller, seller_position, distance_from_current, best_value, &transaction_quantity);  //the rest of the evaluation is done in finding the most valuable buyer for this seller.
 
     return seller_value;
 
@@ -83,38 +90,43 @@ int evaluate_seller(struct bot *b, struct location *seller, int distance_from_cu
 
 //Determines the most valuable buyer for a given seller based on the profit margin between the two minus the cost of travel. 
 //This profit margin is then returned to be used as the seller's value.
-int get_best_value_for_seller(struct bot *b, struct location *seller, int distance_from_current, int **transaction_quantity) {
+//Buyers are taken from the index highest price first, so once a buyer's margin * quantity can no longer beat either "best_value" or the best buyer found so far, no cheaper buyer can either and the search stops.
+int get_best_value_for_seller(struct bot *b, struct buyer_index *index, struct location *seller, int seller_position, int distance_from_current, 
+    int best_value, int **transaction_quantity) {
     int absolute_distance_to_buyer = 0;
     int actual_distance_to_buyer;
-    struct location * buyer = seller;
-    int map_size = size_of_map(b);
+    struct location *buyer;
+    struct commodity_buyers *buyers = buyers_for_commodity(index, seller->commodity);
+    int map_size = index->map_size;
     int quantity_of_transaction = 0;
     int marginal_profit = 0;
     int travel_cost = 0;
     int buyer_value = 0;
     int best_value_for_seller = 0;
     int max_transportable_quantity = **transaction_quantity;
-    int right_comm = TRUE;
 
-    while (right_comm == TRUE) { 
-        buyer = get_location_of_type(b, seller, buyer, & absolute_distance_to_buyer, LOCATION_BUYER);    //evaluates each buyer on the map once.
-        if (buyer == NULL) {
-            right_comm = FALSE;   //If the buyer is not of the right commodity, keep searching.
+    if (buyers == NULL) {
+        return 0;
+    }
+
+    for (int counter = buyers->first_buyer; counter < buyers->first_buyer + buyers->n_buyers; counter++) { 
+        buyer = index->buyers[counter].location;
+
+        marginal_profit = buyer->price - seller->price;   //profit margin found
+
+        if (marginal_profit * max_transportable_quantity <= best_value || 
+            (best_value_for_seller != 0 && marginal_profit * max_transportable_quantity <= best_value_for_seller)) {  //upper bound for this and every remaining buyer
             break;
-        } else if (buyer->commodity != seller->commodity) {
-            buyer = buyer->next;
-            absolute_distance_to_buyer += 1;
-            continue;
         }
 
+        absolute_distance_to_buyer = (index->buyers[counter].position - seller_position + map_size) % map_size;
+
         if (absolute_distance_to_buyer > map_size / 2) {    //sets "actual_distance_to_buyer" to be the length of the shortest route from seller to buyer.
             actual_distance_to_buyer = map_size - absolute_distance_to_buyer;
         } else {
             actual_distance_to_buyer = absolute_distance_to_buyer;
         }
 
-        marginal_profit = buyer->price - seller->price;   //profit margin found
-
         if (buyer->quantity < seller->quantity) {
             quantity_of_transaction = buyer->quantity;    //quantity of transaction set at the the highest quantity each are willing to trade/the bot is able to carry.
         } else {
@@ -128,8 +140,6 @@ int get_best_value_for_seller(struct bot *b, struct location *seller, int distan
 
         if (distance_from_current + actual_distance_to_buyer + best_petrol_distance(b, buyer, actual_distance_to_buyer) > b->fuel && 
               travel_cost > b->cash - (seller->price * quantity_of_transaction)) {
-            buyer = buyer->next;
-            absolute_distance_to_buyer += 1;
             continue;
         }
 
@@ -139,52 +149,28 @@ int get_best_value_for_seller(struct bot *b, struct location *seller, int distan
             best_value_for_seller = buyer_value; 
             **transaction_quantity = quantity_of_transaction;   //This value "transaction_quantity" is then used as the value of *n if this location is chosen as the best value, ensuring no more is bought than can be sold to the buyer.
         }
-
-        buyer = buyer->next;
-        absolute_distance_to_buyer += 1;
-
     }
 
-    return best_value_for_seller;   //Once all buyers have been tested, the best value for the given seller is returned.
+    return best_value_for_seller;   //Once all buyers worth testing have been tested, the best value for the given seller is returned.
 }
 
 
 //Determines a value for the dump as the price of the commodities in cargo that can no longer have a buyer willing to take them.
 //This function was added purely for multi-bot purposes as the bot should never buy more than necessary but a buyer could be sold to before my bot can reach them.
-int evaluate_dump(struct bot *b, struct location *dump, int distance_from_current, int cannot_afford_petrol) {
-    if (cannot_afford_petrol == TRUE) {                       //If the bot is in a state of trying to get enough money together to buy fuel to survive, only dump if there is an adequate enough amount of fuel to then go buy, sell and reach the fuel station again.                    
-        int check = best_petrol_distance(b, dump, distance_from_current);
-        if (distance_from_current + abs(check) > b->fuel + (b->fuel_tank_capacity / 2) || check == 0) {
-            return 0;
-        }
-    }
-
-    int buyers_quantity = buyer_total_for_cargo(b); //finds total of buyer quantities for commodities in cargo
-    int map_size = size_of_map(b);
-    int bot_quantity_total = 0;
-    struct cargo *cargo = b->cargo;
-
-    while (cargo != NULL) {             //determines the total quantities of commodities in cargo
-        bot_quantity_total += cargo->quantity;
-        cargo = cargo->next;
-    }
-
+//"buyers_quantity" (the total of buyer quantities for commodities in cargo, from "buyer_total_for_cargo") and "bot_quantity_total" (the total quantity in cargo) are the same for every dump, so the caller works them out once per scan.
+int evaluate_dump(struct bot *b, struct location *dump, int distance_from_current, int cannot_afford_petrol, int buyers_quantity, int bot_quantity_total) {
     if (buyers_quantity > bot_quantity_total) {   //if there is a way to sell the cargo, there is no need to dump
         return 0;
     }
 
-    cargo = b->cargo;
-    int most_quantity_commodity = 0;        //Finds the price of the nearest buyer for the commodity with the highest quantity in cargo and uses that buyers price as the price per unit to be used in giving the dump a value in "scan_world".
-    struct cargo *most_commodity = cargo;
-
-    while (cargo != NULL) {
-        if (cargo->quantity > most_quantity_commodity) {
-            most_commodity = cargo;
+    if (cannot_afford_petrol == TRUE) {                       //If the bot is in a state of trying to get enough money together to buy fuel to survive, only dump if there is an adequate enough amount of fuel to then go buy, sell and reach the fuel station again.                    
+        int check = best_petrol_distance(b, dump, distance_from_current);
+        if (distance_from_current + abs(check) > b->fuel + (b->fuel_tank_capacity / 2) || check == 0) {
+            return 0;
         }
-        cargo = cargo->next;
     }
 
-    struct location *closest_buyer = dump->next;
+    struct location *closest_buyer = dump->next;       //The price of the nearest buyer for a commodity in cargo is used as the price per unit in giving the dump a value.
     while (closest_buyer != dump) {
         if (closest_buyer->type == LOCATION_BUYER) {
             if (cargo_search(b->cargo, closest_buyer->commodity) != -1) {
@@ -203,4 +189,3 @@ int evaluate_dump(struct bot *b, struct location *dump, int distance_from_curren
 
     return dump_value;
 }
-
@@ -138,8 +138,21 @@ void cargo_capacity_check(struct bot *b, struct cargo *cargo, int *weight_remain
 }
 
 
+//Adds up the quantity of every commodity in cargo.
+//This function is used with "buyer_total_for_cargo" to determine whether some of the cargo will have to be dumped.
+int cargo_quantity_total(struct cargo *cargo) {
+    int bot_quantity_total = 0;
+
+    while (cargo != NULL) {
+        bot_quantity_total += cargo->quantity;
+        cargo = cargo->next;
+    }
+    return bot_quantity_total;
+}
+
+
 //Finds the total of buyer's quantities for all commodities currently in cargo.
-//This function is used in "evaluate_dump" to determine if the current cargo could feasibly find buyers.
+//This function is used with "evaluate_dump" to determine if the current cargo could feasibly find buyers.
 int buyer_total_for_cargo(struct bot *b) {
     struct location *initial = b->location;
     struct location *search = b->location->next;
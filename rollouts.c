@@ -0,0 +1,488 @@
+/*
+This file contains the Monte Carlo rollouts used in multi-bot games.
+The bot's normal decision only looks at the world as it is this turn, so it will happily head for a buyer that another bot is about to empty. Here the best few locations from the scan are each tried out by simulating the next
+ROLLOUT_DEPTH turns on a snapshot of the world (see "world_snapshot.c") against randomly chosen opponent behaviours. The candidate with the best average outcome is chosen.
+Rollouts are run in seed groups (one rollout of every candidate against the same opponents) shared between ROLLOUT_MAX_THREADS worker threads until either ROLLOUT_MAX_ROLLOUTS have been run or ROLLOUT_TIME_BUDGET_MS has passed.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "trader_bot.h"
+#include "trader_header.h"
+
+struct rollout_candidate {
+    int distance;           //signed distance to the location this candidate heads for, 0 to act on the current location
+    int quantity;           //how much to trade on arrival
+    int action;             //the action that would be returned this turn
+    int n;
+    long long total_value;
+};
+
+struct rollout_job {
+    struct world_snapshot *world;
+    struct rollout_candidate *candidates;
+    int n_candidates;
+    unsigned int seed;
+    struct timespec deadline;
+    pthread_mutex_t lock;
+    int n_groups;           //seed groups to run if the time budget allows
+    int next_group;         //shared counter handing out seed groups to the workers, protected by "lock"
+};
+
+
+//xorshift32: each worker keeps its own state so that no locking is needed to draw random numbers.
+static unsigned int rollout_random(unsigned int *state) {
+    unsigned int x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+
+static int wrap_position(struct world_snapshot *world, int position) {
+    position %= world->map_size;
+    if (position < 0) {
+        position += world->map_size;
+    }
+    return position;
+}
+
+
+//Finds the signed distance (shortest direction first) from "position" to the nearest location for which "wanted" returns TRUE, searching no further than "radius". Returns FALSE if there is none.
+static int nearest_location(struct world_snapshot *world, struct snapshot_bot *bot, int radius,
+    int (*wanted)(struct world_snapshot *world, struct snapshot_bot *bot, struct snapshot_location *location), int *distance) {
+
+    if (radius > world->map_size / 2) {
+        radius = world->map_size / 2;
+    }
+    for (int counter = 0; counter <= radius; counter++) {
+        if (wanted(world, bot, &world->locations[wrap_position(world, bot->position + counter)]) == TRUE) {
+            *distance = counter;
+            return TRUE;
+        }
+        if (wanted(world, bot, &world->locations[wrap_position(world, bot->position - counter)]) == TRUE) {
+            *distance = -counter;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+
+static int wants_buyer(struct world_snapshot *world, struct snapshot_bot *bot, struct snapshot_location *location) {
+    (void)world;            //only "wants_seller" needs the world, the others share its signature so "nearest_location" can take any of them
+    return location->type == LOCATION_BUYER && location->commodity >= 0 && location->quantity > 0 && bot->cargo[location->commodity] > 0;
+}
+
+
+static int wants_seller(struct world_snapshot *world, struct snapshot_bot *bot, struct snapshot_location *location) {
+    return location->type == LOCATION_SELLER && location->commodity >= 0 && location->quantity > 0 &&
+        world->max_buyer_price[location->commodity] > location->price && bot->cash >= location->price;
+}
+
+
+static int wants_petrol(struct world_snapshot *world, struct snapshot_bot *bot, struct snapshot_location *location) {
+    (void)world;
+    return location->type == LOCATION_PETROL_STATION && location->quantity > 0 && bot->cash >= location->price;
+}
+
+
+static int has_cargo(struct world_snapshot *world, struct snapshot_bot *bot) {
+    for (int counter = 0; counter < world->n_commodities; counter++) {
+        if (bot->cargo[counter] > 0) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+
+//Moves a bot up to "maximum_move" locations towards a signed distance, limited by its fuel.
+static void move_bot(struct world_snapshot *world, struct snapshot_bot *bot, int distance) {
+    if (distance > world->maximum_move) {
+        distance = world->maximum_move;
+    } else if (distance < -world->maximum_move) {
+        distance = -world->maximum_move;
+    }
+    if (abs(distance) > bot->fuel) {
+        return;
+    }
+    bot->fuel -= abs(distance);
+    bot->position = wrap_position(world, bot->position + distance);
+}
+
+
+//Carries out a buy, sell or dump at the bot's location with the same limits the game applies (stock, cash, cargo space and tank size).
+static void trade_at_location(struct world_snapshot *world, struct snapshot_bot *bot, int quantity) {
+    struct snapshot_location *location = &world->locations[bot->position];
+    int commodity = location->commodity;
+
+    if (quantity > location->quantity) {
+        quantity = location->quantity;
+    }
+    mark_snapshot_location(world, bot->position);
+
+    if (location->type == LOCATION_BUYER && commodity >= 0) {
+        if (quantity > bot->cargo[commodity]) {
+            quantity = bot->cargo[commodity];
+        }
+        bot->cargo[commodity] -= quantity;
+        bot->cash += quantity * location->price;
+        location->quantity -= quantity;
+
+    } else if (location->type == LOCATION_SELLER && commodity >= 0) {
+        int weight_remaining = world->maximum_cargo_weight;
+        int volume_remaining = world->maximum_cargo_volume;
+        for (int counter = 0; counter < world->n_commodities; counter++) {
+            weight_remaining -= bot->cargo[counter] * world->commodity_weight[counter];
+            volume_remaining -= bot->cargo[counter] * world->commodity_volume[counter];
+        }
+        if (quantity > weight_remaining / world->commodity_weight[commodity]) {
+            quantity = weight_remaining / world->commodity_weight[commodity];
+        }
+        if (quantity > volume_remaining / world->commodity_volume[commodity]) {
+            quantity = volume_remaining / world->commodity_volume[commodity];
+        }
+        if (location->price > 0 && quantity > bot->cash / location->price) {
+            quantity = bot->cash / location->price;
+        }
+        if (quantity > 0) {
+            bot->cargo[commodity] += quantity;
+            bot->cash -= quantity * location->price;
+            location->quantity -= quantity;
+        }
+
+    } else if (location->type == LOCATION_PETROL_STATION) {
+        if (quantity > world->fuel_tank_capacity - bot->fuel) {
+            quantity = world->fuel_tank_capacity - bot->fuel;
+        }
+        if (location->price > 0 && quantity > bot->cash / location->price) {
+            quantity = bot->cash / location->price;
+        }
+        if (quantity > 0) {
+            bot->fuel += quantity;
+            bot->cash -= quantity * location->price;
+            location->quantity -= quantity;
+        }
+
+    } else if (location->type == LOCATION_DUMP) {
+        memset(bot->cargo, 0, sizeof bot->cargo);
+    }
+}
+
+
+//Opponent model 1: a greedy bot that sells to the nearest buyer for its cargo, otherwise buys from the nearest profitable seller, and refuels when it runs low.
+//This is also the policy used for our own bot once its candidate action has been carried out.
+static void greedy_turn(struct world_snapshot *world, struct snapshot_bot *bot) {
+    struct snapshot_location *here = &world->locations[bot->position];
+    int radius = world->maximum_move * ROLLOUT_DEPTH;
+    int distance;
+
+    if (wants_buyer(world, bot, here) == TRUE) {
+        trade_at_location(world, bot, here->quantity);
+    } else if (bot->fuel < world->fuel_tank_capacity / 2 && wants_petrol(world, bot, here) == TRUE) {
+        trade_at_location(world, bot, world->fuel_tank_capacity);
+    } else if (has_cargo(world, bot) == FALSE && wants_seller(world, bot, here) == TRUE) {
+        trade_at_location(world, bot, here->quantity);
+    } else if (bot->fuel < 2 * world->maximum_move && nearest_location(world, bot, radius, wants_petrol, &distance) == TRUE) {
+        move_bot(world, bot, distance);
+    } else if (has_cargo(world, bot) == TRUE && nearest_location(world, bot, radius, wants_buyer, &distance) == TRUE) {
+        move_bot(world, bot, distance);
+    } else if (has_cargo(world, bot) == FALSE && nearest_location(world, bot, radius, wants_seller, &distance) == TRUE) {
+        move_bot(world, bot, distance);
+    }
+}
+
+
+//Opponent model 2: a bot that wanders randomly and trades at whatever it lands on half of the time.
+static void random_turn(struct world_snapshot *world, struct snapshot_bot *bot, unsigned int *random_state) {
+    if (rollout_random(random_state) % 2 == 0) {
+        greedy_turn(world, bot);
+    } else {
+        move_bot(world, bot, (int)(rollout_random(random_state) % (2 * world->maximum_move + 1)) - world->maximum_move);
+    }
+}
+
+
+//What a bot is worth at the end of a rollout: its cash plus half the best price its cargo could fetch (half because there is no guarantee it will ever be sold).
+static long long rollout_value(struct world_snapshot *world, struct snapshot_bot *bot) {
+    long long value = bot->cash;
+
+    for (int counter = 0; counter < world->n_commodities; counter++) {
+        value += (long long)bot->cargo[counter] * world->max_buyer_price[counter] / 2;
+    }
+    return value;
+}
+
+
+//Simulates one rollout of a candidate on "world" (which is modified). Opponent behaviours are drawn from "random_state" and every bot takes its turn in a random order each turn, so whoever gets to a contested location first is random as well.
+static long long run_rollout(struct world_snapshot *world, struct rollout_candidate *candidate, unsigned int *random_state) {
+    int random_opponent[MAX_SNAPSHOT_BOTS];
+    int order[MAX_SNAPSHOT_BOTS];
+    int target = wrap_position(world, candidate->distance);
+    int candidate_done = FALSE;
+    int depth = ROLLOUT_DEPTH;
+
+    if (depth > world->turns_left) {
+        depth = world->turns_left;
+    }
+
+    for (int counter = 0; counter < world->n_bots; counter++) {
+        random_opponent[counter] = (rollout_random(random_state) % 4 == 0);   //one opponent in four is modelled as a wanderer, the rest as greedy traders
+        order[counter] = counter;
+    }
+
+    for (int turn = 0; turn < depth; turn++) {
+        for (int counter = world->n_bots - 1; counter > 0; counter--) {      //shuffles the turn order
+            int swap = rollout_random(random_state) % (counter + 1);
+            int temp = order[counter];
+            order[counter] = order[swap];
+            order[swap] = temp;
+        }
+
+        for (int counter = 0; counter < world->n_bots; counter++) {
+            struct snapshot_bot *bot = &world->bots[order[counter]];
+
+            if (order[counter] != 0) {
+                if (random_opponent[order[counter]] == TRUE) {
+                    random_turn(world, bot, random_state);
+                } else {
+                    greedy_turn(world, bot);
+                }
+            } else if (candidate_done == TRUE) {
+                greedy_turn(world, bot);
+            } else if (bot->position != target) {          //our bot heads for the candidate's location...
+                int distance = candidate->distance > 0 ? wrap_position(world, target - bot->position) : -wrap_position(world, bot->position - target);
+                move_bot(world, bot, distance);
+            } else {                                       //...and trades there once it arrives
+                trade_at_location(world, bot, candidate->quantity);
+                candidate_done = TRUE;
+            }
+        }
+    }
+
+    return rollout_value(world, &world->bots[0]);
+}
+
+
+static int deadline_passed(struct timespec *deadline) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > deadline->tv_sec || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+
+//Worker thread: takes seed groups ROLLOUT_BATCH at a time from the shared counter and runs them on its own copy of the world, which is reset after each rollout.
+//Every candidate in a group is given the group's random seed so that they all face the same opponents. A batch is always finished once taken, so when the time budget runs out every candidate has still been tried against exactly the same seeds.
+static void *rollout_worker(void *argument) {
+    struct rollout_job *job = argument;
+    struct world_snapshot copy;
+    long long total_value[ROLLOUT_CANDIDATES] = {0};
+
+    copy.locations = malloc(job->world->map_size * sizeof (struct snapshot_location));
+    assert(copy.locations != NULL);
+    copy_world_snapshot(&copy, job->world);
+
+    while (deadline_passed(&job->deadline) == FALSE) {
+        pthread_mutex_lock(&job->lock);
+        int first = job->next_group;
+        job->next_group += ROLLOUT_BATCH;
+        pthread_mutex_unlock(&job->lock);
+
+        if (first >= job->n_groups) {
+            break;
+        }
+
+        for (int group = first; group < first + ROLLOUT_BATCH && group < job->n_groups; group++) {
+            for (int candidate = 0; candidate < job->n_candidates; candidate++) {
+                unsigned int random_state = job->seed ^ ((group + 1) * 2654435761u);
+
+                if (random_state == 0) {
+                    random_state = 1;
+                }
+                total_value[candidate] += run_rollout(&copy, &job->candidates[candidate], &random_state);
+                reset_world_snapshot(&copy, job->world);
+            }
+        }
+    }
+
+    pthread_mutex_lock(&job->lock);
+    for (int counter = 0; counter < job->n_candidates; counter++) {
+        job->candidates[counter].total_value += total_value[counter];
+    }
+    pthread_mutex_unlock(&job->lock);
+
+    free(copy.locations);
+    return NULL;
+}
+
+
+//Turns a location at a signed distance into a candidate. Returns FALSE if there is nothing to be done there.
+static int make_candidate(struct bot *b, struct location *location, int distance, int quantity, struct rollout_candidate *candidate) {
+    candidate->distance = distance;
+    candidate->total_value = 0;
+
+    if (location->type == LOCATION_BUYER) {
+        candidate->action = ACTION_SELL;
+        candidate->quantity = location->quantity;
+    } else if (location->type == LOCATION_SELLER) {
+        candidate->action = ACTION_BUY;
+        candidate->quantity = quantity;
+    } else if (location->type == LOCATION_PETROL_STATION) {
+        candidate->action = ACTION_BUY;
+        candidate->quantity = b->fuel_tank_capacity;
+    } else if (location->type == LOCATION_DUMP) {
+        candidate->action = ACTION_DUMP;
+        candidate->quantity = 0;
+    } else {
+        return FALSE;
+    }
+
+    candidate->n = candidate->quantity;
+    if (distance != 0) {
+        candidate->action = ACTION_MOVE;
+        candidate->n = distance;
+    }
+    return TRUE;
+}
+
+
+//Collects the best ROLLOUT_CANDIDATES - 1 locations on the map using the same evaluations as "scan_world". Only locations the bot can reach and then still reach petrol from are kept.
+static int collect_candidates(struct bot *b, struct buyer_index *index, struct rollout_candidate *candidates) {
+    int best_values[ROLLOUT_CANDIDATES];
+    struct location *best_locations[ROLLOUT_CANDIDATES];
+    int best_distances[ROLLOUT_CANDIDATES];
+    int best_quantities[ROLLOUT_CANDIDATES];
+    int n_best = 0;
+    struct location *current = b->location;
+    int position = 0;
+    int buyers_quantity = buyer_total_for_cargo(b);
+    int bot_quantity_total = cargo_quantity_total(b->cargo);
+
+    do {
+        int distance = position <= index->map_size / 2 ? position : position - index->map_size;
+        int value = 0;
+        int transaction_quantity = 0;
+        int worst = n_best == ROLLOUT_CANDIDATES - 1 ? best_values[n_best - 1] : 0;     //a location only has to beat the worst value kept so far
+
+        if (current->type == LOCATION_BUYER) {
+            value = evaluate_buyer(b, current, abs(distance), FALSE);
+        } else if (current->type == LOCATION_SELLER && b->turns_left >= MIN_TURNS_TO_BUY_AND_SELL) {
+            value = evaluate_seller(b, index, current, position, abs(distance), worst, &transaction_quantity);
+        } else if (current->type == LOCATION_DUMP && b->turns_left >= MIN_TURNS_TO_ACTION_THEN_MAKE_PROFIT) {
+            value = evaluate_dump(b, current, abs(distance), FALSE, buyers_quantity, bot_quantity_total);
+        }
+
+        if (value > worst) {                        //insertion into the list of best values, which is kept sorted highest first
+            int slot = n_best < ROLLOUT_CANDIDATES - 1 ? n_best++ : n_best - 1;
+            while (slot > 0 && best_values[slot - 1] < value) {
+                best_values[slot] = best_values[slot - 1];
+                best_locations[slot] = best_locations[slot - 1];
+                best_distances[slot] = best_distances[slot - 1];
+                best_quantities[slot] = best_quantities[slot - 1];
+                slot--;
+            }
+            best_values[slot] = value;
+            best_locations[slot] = current;
+            best_distances[slot] = distance;
+            best_quantities[slot] = transaction_quantity;
+        }
+
+        current = current->next;
+        position++;
+    } while (current != b->location);
+
+    int n_candidates = 0;
+    for (int counter = 0; counter < n_best; counter++) {
+        if (fuelcheck(b, best_distances[counter]) == 0 &&
+            make_candidate(b, best_locations[counter], best_distances[counter], best_quantities[counter], &candidates[n_candidates]) == TRUE) {
+            n_candidates++;
+        }
+    }
+    return n_candidates;
+}
+
+
+//Called by "get_action" in multi-bot games once it has decided on "*action" and "*n". That decision is rolled out alongside the best alternatives from the map, and replaced if one of them does better on average against the sampled opponents.
+//Nothing is changed if the bot is alone on the map, if there is no alternative worth trying or if the world does not fit in a snapshot.
+void choose_action_by_rollouts(struct bot *b, struct buyer_index *index, int *action, int *n, int best_value_quantity) {
+    struct rollout_candidate candidates[ROLLOUT_CANDIDATES];
+    struct location *target = b->location;
+    int distance = *action == ACTION_MOVE ? *n : 0;
+
+    if (index->n_other_bots == 0 || b->turns_left < MIN_TURNS_TO_BUY_AND_SELL) {     //the bots were counted when the index was built, so a single-bot game returns before any more of the map is looked at
+        return;
+    }
+
+    for (int counter = 0; counter < abs(distance); counter++) {
+        target = distance > 0 ? target->next : target->previous;
+    }
+    if (make_candidate(b, target, distance, best_value_quantity, &candidates[0]) == FALSE) {
+        return;
+    }
+    candidates[0].action = *action;         //the decision already made is kept exactly as it is
+    candidates[0].n = *n;
+
+    int n_candidates = 1 + collect_candidates(b, index, &candidates[1]);
+    for (int counter = 1; counter < n_candidates; counter++) {   //the alternatives must not include the decision already made
+        if (candidates[counter].distance == candidates[0].distance) {
+            candidates[counter--] = candidates[--n_candidates];
+        }
+    }
+    if (n_candidates < 2) {
+        return;
+    }
+
+    struct world_snapshot *world = build_world_snapshot(b);
+    if (world == NULL) {
+        return;
+    }
+
+    struct rollout_job job;
+    job.world = world;
+    job.candidates = candidates;
+    job.n_candidates = n_candidates;
+    job.seed = ((unsigned int)b->turns_left * 2246822519u) ^ (unsigned int)b->cash;     //seeded from the bot's state, so the same turn makes the same decision unless the time budget cuts the rollouts short, in which case how many groups are run depends on timing
+    job.n_groups = ROLLOUT_MAX_ROLLOUTS / n_candidates;
+    job.next_group = 0;
+    pthread_mutex_init(&job.lock, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &job.deadline);
+    job.deadline.tv_nsec += ROLLOUT_TIME_BUDGET_MS * 1000000L;
+    job.deadline.tv_sec += job.deadline.tv_nsec / 1000000000L;
+    job.deadline.tv_nsec %= 1000000000L;
+
+    pthread_t threads[ROLLOUT_MAX_THREADS];
+    int n_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (n_threads > ROLLOUT_MAX_THREADS) {
+        n_threads = ROLLOUT_MAX_THREADS;
+    }
+    int started = 0;
+    while (started < n_threads - 1 && pthread_create(&threads[started], NULL, rollout_worker, &job) == 0) {
+        started++;
+    }
+    rollout_worker(&job);                   //this thread does its share of the work too
+    for (int counter = 0; counter < started; counter++) {
+        pthread_join(threads[counter], NULL);
+    }
+    pthread_mutex_destroy(&job.lock);
+    free_world_snapshot(world);
+
+    int best = 0;
+    for (int counter = 1; counter < n_candidates; counter++) {    //every candidate ran the same seed groups, so totals compare directly
+        if (candidates[counter].total_value > candidates[best].total_value) {
+            best = counter;
+        }
+    }
+
+    *action = candidates[best].action;
+    *n = candidates[best].n;
+}
@@ -0,0 +1,338 @@
+/*
+This file contains the multi-stop trade tour planner.
+"scan_world" only ever picks a single location, so the bot cannot see that it would be better to e.g. buy from 2 cheap sellers on the way to 2 buyers further along. On a ring any tour that does not double back is an arc starting at the bot,
+so for each direction and each commodity the planner runs a dynamic program over the sellers and buyers along the arc that can be reached with the fuel in the tank. The state is (number of trades made, cargo held) and the value
+is the cash made so far, which also lets each purchase be checked against the cash the bot would have at that point. Cargo is counted in PLAN_LOTS lots sized so that a full hold (as found by "cargo_capacity_check") is PLAN_LOTS lots.
+The petrol cost of a tour is found with "best_petrol_cost" in the same way as "evaluate_seller" does it.
+
+The plan is cached between turns and followed step by step by "follow_trade_plan" until it is finished or the world no longer matches it (prices changed, stock bought out by another bot, the bot somewhere unexpected...).
+Plans are kept per bot (up to PLAN_MAX_BOTS of them) so that several bots running this code in the same process do not wipe each other's tours.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <limits.h>
+#include "trader_bot.h"
+#include "trader_header.h"
+
+#define NO_VALUE INT_MIN
+
+struct trade_plan_step {
+    struct location *location;
+    int action;                     //ACTION_BUY or ACTION_SELL
+    int quantity;
+    int price;                      //price when the plan was made, the plan is dropped if this changes
+};
+
+struct trade_plan {
+    struct bot *bot;
+    int turns_left;                 //turns left when the plan was last followed, used to spot a new game
+    int direction;                  //1 forwards, -1 backwards
+    int value;
+    int n_steps;
+    int next_step;
+    struct trade_plan_step steps[PLAN_MAX_STOPS];
+};
+
+struct tour_stop {
+    struct location *location;
+    int distance;                   //distance from the bot along the arc
+};
+
+static struct trade_plan cached_plans[PLAN_MAX_BOTS];
+
+
+static int same_commodity(struct commodity *first, struct commodity *second) {
+    return first == second || strcmp(first->name, second->name) == 0;
+}
+
+
+//Quantity of a commodity the bot is carrying.
+static int cargo_quantity(struct bot *b, struct commodity *commodity) {
+    for (struct cargo *cargo = b->cargo; cargo != NULL; cargo = cargo->next) {
+        if (same_commodity(cargo->commodity, commodity)) {
+            return cargo->quantity;
+        }
+    }
+    return 0;
+}
+
+
+//Turns needed for a tour: every location moved past costs 1 / maximum_move of a turn, each trade takes a turn and can also split a move in 2.
+static int tour_turns(struct bot *b, int distance, int trades) {
+    return (distance + b->maximum_move - 1) / b->maximum_move + 2 * trades;
+}
+
+
+//Runs the dynamic program for one commodity over "stops" (sellers and buyers of that commodity in arc order). If it finds a tour better than "plan->value" the plan is replaced.
+//"petrol_costs" caches "best_petrol_cost" for the end of a tour at each distance along the arc, as every (trades, lots) state ending at the same buyer needs it.
+static void plan_commodity(struct bot *b, struct commodity *commodity, struct tour_stop *stops, int n_stops, int direction, int *petrol_costs, struct trade_plan *plan) {
+    int held = cargo_quantity(b, commodity);
+    int weight_remaining = b->maximum_cargo_weight;
+    int volume_remaining = b->maximum_cargo_volume;
+
+    cargo_capacity_check(b, b->cargo, &weight_remaining, &volume_remaining);
+    int space = weight_remaining / commodity->weight < volume_remaining / commodity->volume ?
+        weight_remaining / commodity->weight : volume_remaining / commodity->volume;
+    if (space < 0) {
+        space = 0;
+    }
+    if (held + space == 0) {
+        return;
+    }
+
+    int lot = (held + space + PLAN_LOTS - 1) / PLAN_LOTS;
+    int held_lots = held / lot;
+    int max_lots = held_lots + space / lot;
+    int states = (PLAN_MAX_STOPS + 1) * (PLAN_LOTS + 1);
+    int *values = malloc(states * sizeof (int));
+    int *previous_lots = malloc(n_stops * states * sizeof (int));     //for each stop and state, the lots held before trading there, or -1 if nothing was traded there
+    assert(values != NULL && previous_lots != NULL);
+
+    for (int state = 0; state < states; state++) {
+        values[state] = NO_VALUE;
+    }
+    values[held_lots] = 0;                       //no trades yet, holding what is already in cargo
+
+    for (int stop = 0; stop < n_stops; stop++) {
+        struct location *location = stops[stop].location;
+        int *previous = &previous_lots[stop * states];
+
+        for (int state = 0; state < states; state++) {
+            previous[state] = -1;
+        }
+
+        for (int trades = PLAN_MAX_STOPS - 1; trades >= 0; trades--) {    //trades counts down so that each stop is traded at no more than once
+            for (int lots = 0; lots <= PLAN_LOTS; lots++) {
+                int value = values[trades * (PLAN_LOTS + 1) + lots];
+                if (value == NO_VALUE) {
+                    continue;
+                }
+
+                if (location->type == LOCATION_SELLER) {
+                    for (int bought = 1; lots + bought <= max_lots && bought * lot <= location->quantity; bought++) {
+                        int new_value = value - bought * lot * location->price;
+                        int new_state = (trades + 1) * (PLAN_LOTS + 1) + lots + bought;
+                        if (b->cash + new_value >= 0 && new_value > values[new_state]) {
+                            values[new_state] = new_value;
+                            previous[new_state] = lots;
+                        }
+                    }
+                } else {
+                    for (int sold = 1; sold <= lots && sold * lot <= location->quantity; sold++) {
+                        int new_value = value + sold * lot * location->price;
+                        int new_state = (trades + 1) * (PLAN_LOTS + 1) + lots - sold;
+                        if (new_value > values[new_state]) {
+                            values[new_state] = new_value;
+                            previous[new_state] = lots;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (location->type != LOCATION_BUYER) {   //a tour worth taking ends with a sale
+            continue;
+        }
+        for (int trades = 2; trades <= PLAN_MAX_STOPS; trades++) {     //single trades are already covered by "scan_world"
+            for (int lots = 0; lots <= PLAN_LOTS; lots++) {
+                int state = trades * (PLAN_LOTS + 1) + lots;
+                if (previous[state] < 0 || tour_turns(b, stops[stop].distance, trades) > b->turns_left) {
+                    continue;
+                }
+                if (petrol_costs[stops[stop].distance] == NO_VALUE) {
+                    petrol_costs[stops[stop].distance] = best_petrol_cost(b, location, stops[stop].distance);
+                }
+                int value = values[state] - petrol_costs[stops[stop].distance];
+                if (value <= plan->value) {
+                    continue;
+                }
+
+                plan->value = value;               //new best tour: walk the back pointers to recover its steps
+                plan->direction = direction;
+                plan->n_steps = trades;
+                int step_lots = lots;
+                int step = trades - 1;
+                for (int counter = stop; counter >= 0 && step >= 0; counter--) {
+                    int before = previous_lots[counter * states + (step + 1) * (PLAN_LOTS + 1) + step_lots];
+                    if (before < 0) {
+                        continue;
+                    }
+                    plan->steps[step].location = stops[counter].location;
+                    plan->steps[step].price = stops[counter].location->price;
+                    plan->steps[step].action = stops[counter].location->type == LOCATION_SELLER ? ACTION_BUY : ACTION_SELL;
+                    plan->steps[step].quantity = abs(step_lots - before) * lot;
+                    step_lots = before;
+                    step--;
+                }
+            }
+        }
+    }
+
+    free(values);
+    free(previous_lots);
+}
+
+
+//Plans the best tour in one direction. Sellers and buyers within the arc the bot can cover on its current fuel are collected once and then handed to "plan_commodity" one commodity at a time.
+static void plan_direction(struct bot *b, int direction, struct trade_plan *plan) {
+    int map_size = size_of_map(b);
+    int horizon = b->fuel < map_size - 1 ? b->fuel : map_size - 1;
+    struct tour_stop *stops = malloc((horizon + 1) * sizeof (struct tour_stop));
+    struct tour_stop *commodity_stops = malloc((horizon + 1) * sizeof (struct tour_stop));
+    int *petrol_costs = malloc((horizon + 1) * sizeof (int));
+    struct location *current = b->location;
+    int n_stops = 0;
+
+    assert(stops != NULL && commodity_stops != NULL && petrol_costs != NULL);
+    for (int distance = 0; distance <= horizon; distance++) {
+        if ((current->type == LOCATION_SELLER || current->type == LOCATION_BUYER) && current->commodity != NULL && current->quantity > 0) {
+            stops[n_stops].location = current;
+            stops[n_stops].distance = distance;
+            n_stops++;
+        }
+        petrol_costs[distance] = NO_VALUE;
+        current = direction > 0 ? current->next : current->previous;
+    }
+
+    for (int first = 0; first < n_stops; first++) {     //each commodity is planned once, from the first stop it appears at
+        struct commodity *commodity = stops[first].location->commodity;
+        int seen = FALSE;
+        for (int counter = 0; counter < first && seen == FALSE; counter++) {
+            seen = same_commodity(stops[counter].location->commodity, commodity);
+        }
+        if (seen == TRUE) {
+            continue;
+        }
+
+        int n_commodity_stops = 0;
+        int has_buyer = FALSE;
+        for (int counter = first; counter < n_stops; counter++) {
+            if (same_commodity(stops[counter].location->commodity, commodity)) {
+                commodity_stops[n_commodity_stops] = stops[counter];
+                n_commodity_stops++;
+                if (stops[counter].location->type == LOCATION_BUYER) {
+                    has_buyer = TRUE;
+                }
+            }
+        }
+        if (has_buyer == TRUE && n_commodity_stops >= 2) {
+            plan_commodity(b, commodity, commodity_stops, n_commodity_stops, direction, petrol_costs, plan);
+        }
+    }
+
+    free(stops);
+    free(commodity_stops);
+    free(petrol_costs);
+}
+
+
+//Returns the cached plan of bot "b", or NULL if it has none.
+static struct trade_plan *find_trade_plan(struct bot *b) {
+    for (int counter = 0; counter < PLAN_MAX_BOTS; counter++) {
+        if (cached_plans[counter].bot == b) {
+            return &cached_plans[counter];
+        }
+    }
+    return NULL;
+}
+
+
+//Returns somewhere to cache a new plan for bot "b": its own slot if it has one, otherwise a slot that is unused or holds a finished or dropped plan. Returns NULL if every slot holds another bot's plan in progress.
+static struct trade_plan *free_trade_plan(struct bot *b) {
+    struct trade_plan *plan = find_trade_plan(b);
+
+    for (int counter = 0; counter < PLAN_MAX_BOTS && plan == NULL; counter++) {
+        if (cached_plans[counter].bot == NULL || cached_plans[counter].next_step >= cached_plans[counter].n_steps) {
+            plan = &cached_plans[counter];
+        }
+    }
+    return plan;
+}
+
+
+//Follows the cached plan of bot "b" if there is one and the world still matches it, setting "*action" and "*n" and returning TRUE. Otherwise the plan is dropped and FALSE is returned so "get_action" decides as normal.
+int follow_trade_plan(struct bot *b, int *action, int *n) {
+    struct trade_plan *plan = find_trade_plan(b);
+
+    if (plan == NULL) {
+        return FALSE;
+    }
+    if (plan->next_step >= plan->n_steps || b->turns_left > plan->turns_left) {
+        plan->n_steps = 0;
+        return FALSE;
+    }
+    plan->turns_left = b->turns_left;
+
+    struct trade_plan_step *step = &plan->steps[plan->next_step];
+    struct location *current = b->location;
+    int distance = 0;
+
+    while (current != step->location && distance < b->fuel) {       //the next stop must still be ahead of the bot in the plan's direction and within reach
+        current = plan->direction > 0 ? current->next : current->previous;
+        distance++;
+    }
+
+    int diverged = current != step->location || step->location->price != step->price ||
+        step->location->quantity < step->quantity || tour_turns(b, distance, 1) > b->turns_left;
+    if (step->action == ACTION_BUY && b->cash < step->quantity * step->price) {
+        diverged = TRUE;
+    }
+    if (step->action == ACTION_SELL && cargo_quantity(b, step->location->commodity) < step->quantity) {
+        diverged = TRUE;
+    }
+    if (diverged) {
+        plan->n_steps = 0;
+        return FALSE;
+    }
+
+    if (distance == 0) {
+        *action = step->action;
+        *n = step->quantity;
+        plan->next_step++;
+    } else {
+        *action = ACTION_MOVE;
+        *n = plan->direction * distance;
+    }
+    return TRUE;
+}
+
+
+//Plans the best multi-stop tour in both directions. If it is worth more than "best_value" (the single location chosen by "scan_world") and leaves enough fuel to reach petrol afterwards, it is cached and its first step is returned through "*action" and "*n".
+int start_trade_plan(struct bot *b, int best_value, int *action, int *n) {
+    struct trade_plan *cached_plan = free_trade_plan(b);
+    struct trade_plan plan;
+
+    if (cached_plan == NULL) {                    //no room to remember a tour, so none is started
+        return FALSE;
+    }
+
+    plan.value = best_value;
+    plan.n_steps = 0;
+    plan_direction(b, 1, &plan);
+    plan_direction(b, -1, &plan);
+    if (plan.n_steps == 0) {
+        return FALSE;
+    }
+
+    struct location *end = plan.steps[plan.n_steps - 1].location;
+    struct location *current = b->location;
+    int distance = 0;
+    while (current != end) {
+        current = plan.direction > 0 ? current->next : current->previous;
+        distance++;
+    }
+    int remaining_turns = b->turns_left - tour_turns(b, distance, plan.n_steps);
+    int petrol_distance = best_petrol_distance(b, end, distance);
+    if (remaining_turns >= MIN_TURNS_TO_ACTION_THEN_MAKE_PROFIT && (petrol_distance == 0 || distance + abs(petrol_distance) > b->fuel)) {
+        return FALSE;                             //would be stranded after the tour with time left to make money
+    }
+
+    plan.bot = b;
+    plan.turns_left = b->turns_left;
+    plan.next_step = 0;
+    *cached_plan = plan;
+    return follow_trade_plan(b, action, n);
+}
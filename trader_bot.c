@@ -28,8 +28,15 @@ void get_action(struct bot *b, int *action, int *n) {
     struct location *start = b->location;
     int best_value = 0, best_value_quantity = 0, distance_to_best_value = 0;
     int cannot_afford_petrol = FALSE;
+    int enough_fuel_for_best_value = FALSE;
 
-    scan_world(b, start, &best_value, &distance_to_best_value, &best_value_quantity, cannot_afford_petrol); //The most valuable location in terms of profit (or future profit for a sellers commodity) is determined in "scan_world"
+    if (follow_trade_plan(b, action, n) == TRUE) {    //A multi-stop tour planned on an earlier turn (see "tour_planner.c") is followed until it is finished or no longer matches the world. Other bots are not checked for here: a stop they have emptied no longer matches the plan, which is then dropped.
+        return;
+    }
+
+    struct buyer_index *index = build_buyer_index(b);    //buyers sorted by price for each commodity, shared by every seller evaluation this turn
+
+    scan_world(b, index, start, &best_value, &distance_to_best_value, &best_value_quantity, cannot_afford_petrol); //The most valuable location in terms of profit (or future profit for a sellers commodity) is determined in "scan_world"
 
     if (start->type == LOCATION_PETROL_STATION && b->fuel != b->fuel_tank_capacity && start->quantity >= bots_on_location(start) 
         && best_petrol_cost(b, start, 0) != 0 && b->cash > start->price) {            //If the starting location is a petrol station and the bot both needs and can afford fuel, fuel up this turn 
@@ -45,7 +52,7 @@ void get_action(struct bot *b, int *action, int *n) {
             best_value_quantity = 0;
             distance_to_best_value = 0;
             cannot_afford_petrol = TRUE;
-            scan_world(b, start, &best_value, &distance_to_best_value, &best_value_quantity, cannot_afford_petrol); //"cannot_afford_petrol" becoming true is the trigger used within "scan_world" to fulfil the process outlined in the above comment.
+            scan_world(b, index, start, &best_value, &distance_to_best_value, &best_value_quantity, cannot_afford_petrol); //"cannot_afford_petrol" becoming true is the trigger used within "scan_world" to fulfil the process outlined in the above comment.
             *n = distance_to_best_value; 
             *action = ACTION_MOVE;
         }
@@ -53,6 +60,7 @@ void get_action(struct bot *b, int *action, int *n) {
     } else {                  //If there is enough fuel to move to the location of best value, do so.
         *action = ACTION_MOVE; 
         *n = distance_to_best_value;
+        enough_fuel_for_best_value = TRUE;
     }
 
     if (distance_to_best_value == 0) {     //If the best value is at the current location it is time to do something other than move
@@ -112,13 +120,23 @@ c) Fuel has become relatively expensive in my algorthms for evaluating locations
         *action = ACTION_MOVE; 
         *n = b->maximum_move;
     }
+
+    if (enough_fuel_for_best_value == TRUE && best_value > 0 && start_trade_plan(b, best_value, action, n) == TRUE) {    //A tour through several sellers and buyers is taken instead if it is worth more than the single best value location.
+        enough_fuel_for_best_value = FALSE;
+    }
+
+    if (enough_fuel_for_best_value == TRUE && best_value > 0) {    //Other bots may reach the best value location first. When there are any, the decision is checked against the next best locations by simulating the next few turns (see "rollouts.c"). Refuelling and end of game decisions are left alone.
+        choose_action_by_rollouts(b, index, action, n, best_value_quantity);
+    }
+
+    free_buyer_index(index);
 }
 
 
 //Cycles through every location on the map and gives values to all buyers, sellers and dumps. The best value location and appropriate extra information (e.g. distance to the location from the bots current position) is then passed. 
 //This function is the crux of my trader_bot system. Each algorithm called within is tuned to each location type in hopes of giving a fair evaluation as an integer value which is comparable to the values returned for the 2 other location types assessed.
 //It is noted that "evaluate_buyer" is given an edge over the others as it does not account for the margin, simply the immediate revenue. This faster cycle of buying and selling seemed to result in the most profit in practice.
-void scan_world(struct bot *b, struct location *start, int *best_value, int *distance_to_best_value, 
+void scan_world(struct bot *b, struct buyer_index *index, struct location *start, int *best_value, int *distance_to_best_value, 
     int *best_value_quantity, int cannot_afford_petrol) {
 
     struct location *forwards = start;
@@ -126,6 +144,13 @@ void scan_world(struct bot *b, struct location *start, int *best_value, int *dis
     int distance = 0;
     int value = 0;
     int transaction_quantity = 0;
+    int buyers_quantity = 0;
+    int bot_quantity_total = 0;
+
+    if (b->turns_left >= MIN_TURNS_TO_ACTION_THEN_MAKE_PROFIT) {      //The cargo totals "evaluate_dump" compares are the same for every dump, so they are found once here rather than once per dump.
+        buyers_quantity = buyer_total_for_cargo(b);
+        bot_quantity_total = cargo_quantity_total(b->cargo);
+    }
 
     while (distance < 2 || (backwards != forwards->previous && backwards != forwards->previous->previous)) {    //cycles through the entire map until the initial location is reached
         if (forwards->type == LOCATION_BUYER) {                                   //Only buyers are evaluated in the last 3 turns of the game as it requres a minimum of 4 turns to complete a seller-buyer transaction. 
@@ -136,7 +161,7 @@ void scan_world(struct bot *b, struct location *start, int *best_value, int *dis
             }
 
         } else if (forwards->type == LOCATION_SELLER && b->turns_left >= MIN_TURNS_TO_BUY_AND_SELL) {                   
-            value = evaluate_seller(b, forwards, distance, &transaction_quantity);
+            value = evaluate_seller(b, index, forwards, distance % index->map_size, distance, *best_value, &transaction_quantity);
             if (value > *best_value) { 
                 *best_value = value; 
                 *best_value_quantity = transaction_quantity; 
@@ -144,7 +169,7 @@ void scan_world(struct bot *b, struct location *start, int *best_value, int *dis
             }
 
         } else if (forwards->type == LOCATION_DUMP && b->turns_left >= MIN_TURNS_TO_ACTION_THEN_MAKE_PROFIT) {
-            value = evaluate_dump(b, forwards, distance, cannot_afford_petrol);
+            value = evaluate_dump(b, forwards, distance, cannot_afford_petrol, buyers_quantity, bot_quantity_total);
             if (value > *best_value) { 
                 *best_value = value; 
                 *best_value_quantity = transaction_quantity;
@@ -160,18 +185,18 @@ void scan_world(struct bot *b, struct location *start, int *best_value, int *dis
             }
 
         } else if (backwards->type == LOCATION_SELLER && b->turns_left >= MIN_TURNS_TO_BUY_AND_SELL) {
-            value = evaluate_seller(b, backwards, distance, &transaction_quantity);
+            value = evaluate_seller(b, index, backwards, (index->map_size - distance) % index->map_size, distance, *best_value, &transaction_quantity);
             if (value > *best_value) { 
                 *best_value = value; 
                 *best_value_quantity = transaction_quantity; 
                 *distance_to_best_value = -distance;
             }
         } else if (backwards->type == LOCATION_DUMP && b->turns_left >= MIN_TURNS_TO_ACTION_THEN_MAKE_PROFIT) {
-            value = evaluate_dump(b, backwards, distance, cannot_afford_petrol);
+            value = evaluate_dump(b, backwards, distance, cannot_afford_petrol, buyers_quantity, bot_quantity_total);
             if (value > *best_value) { 
                 *best_value = value; 
                 *best_value_quantity = transaction_quantity; 
-                *distance_to_best_value = distance;
+                *distance_to_best_value = -distance;
             }
         }
 
@@ -2,13 +2,94 @@
 #define FALSE 0
 #define MIN_TURNS_TO_BUY_AND_SELL 3
 #define MIN_TURNS_TO_ACTION_THEN_MAKE_PROFIT 6
+#define MAX_SNAPSHOT_COMMODITIES 32
+#define MAX_SNAPSHOT_BOTS 16
+#define MAX_SNAPSHOT_CHANGES 256
+#define ROLLOUT_CANDIDATES 4
+#define ROLLOUT_DEPTH 8
+#define ROLLOUT_MAX_ROLLOUTS 4096
+#define ROLLOUT_BATCH 4
+#define ROLLOUT_MAX_THREADS 8
+#define ROLLOUT_TIME_BUDGET_MS 100
+#define PLAN_MAX_STOPS 4
+#define PLAN_LOTS 8
+#define PLAN_MAX_BOTS 16
+
+struct indexed_buyer {
+    struct location *location;
+    int position;                   //distance forwards from the bot's location at the start of the turn
+};
+
+struct commodity_buyers {
+    struct commodity *commodity;
+    int max_price;
+    int first_buyer;                //buyers of this commodity are buyers[first_buyer] to buyers[first_buyer + n_buyers - 1], highest price first
+    int n_buyers;
+};
+
+struct buyer_index {
+    int map_size;
+    int n_other_bots;               //bots other than this one seen on the map, used to skip the rollouts in single-bot games
+    int n_buyers;
+    int n_commodities;
+    struct indexed_buyer *buyers;
+    struct commodity_buyers *commodities;
+};
+
+struct snapshot_location {
+    int type;
+    int commodity;                  //snapshot commodity id, -1 if the location has no commodity
+    int price;
+    int quantity;
+};
+
+struct snapshot_bot {
+    int position;
+    int fuel;
+    int cash;
+    int cargo[MAX_SNAPSHOT_COMMODITIES];    //quantity carried of each snapshot commodity
+};
+
+struct world_snapshot {
+    int map_size;
+    int turns_left;
+    int fuel_tank_capacity;
+    int maximum_move;
+    int maximum_cargo_weight;
+    int maximum_cargo_volume;
+    int n_commodities;
+    struct commodity *commodities[MAX_SNAPSHOT_COMMODITIES];
+    int commodity_weight[MAX_SNAPSHOT_COMMODITIES];
+    int commodity_volume[MAX_SNAPSHOT_COMMODITIES];
+    int max_buyer_price[MAX_SNAPSHOT_COMMODITIES];
+    int n_bots;
+    struct snapshot_bot bots[MAX_SNAPSHOT_BOTS];    //bots[0] is the bot the snapshot was built for
+    int n_petrol_stations;
+    int *petrol_stations;                           //positions of every petrol station in map order, shared read-only by all copies
+    int first_buyer[MAX_SNAPSHOT_COMMODITIES + 1];  //buyers of commodity c are buyers[first_buyer[c]] to buyers[first_buyer[c + 1] - 1], highest price first
+    int *buyers;                                    //positions, shared read-only by all copies
+    int n_changed;                                  //positions of the locations changed since this copy was made, -1 if there were too many to list
+    int changed[MAX_SNAPSHOT_CHANGES];
+    struct snapshot_location *locations;            //locations[i] is i locations forwards from bots[0]'s location when the snapshot was built
+};
+
+struct hypothetical_state {
+    int bot;                        //snapshot bot the state was made from, so it is not counted twice, or -1 for a bot that is not in the snapshot
+    int position;                   //position in the snapshot the state is evaluated against
+    int fuel;
+    int cash;
+    int turns_left;
+    int cargo[MAX_SNAPSHOT_COMMODITIES];
+};
 
 void get_action(struct bot *b, int *action, int *n);
-void scan_world(struct bot *b, struct location *start, int *best_value, int *distance_to_best_value, int *best_value_quantity, int cannot_afford_petrol);
+void scan_world(struct bot *b, struct buyer_index *index, struct location *start, int *best_value, int *distance_to_best_value, int *best_value_quantity, int cannot_afford_petrol);
 int evaluate_buyer(struct bot *b, struct location *buyer, int distance_from_current, int cannot_afford_petrol);
-int evaluate_seller(struct bot *b, struct location *seller, int distance_from_current, int *transaction_quantity);
-int get_best_value_for_seller(struct bot *b, struct location *seller, int distance_from_current, int **transaction_quantity);
-int evaluate_dump(struct bot *b, struct location *dump, int distance_from_current, int cannot_afford_petrol);
+int evaluate_seller(struct bot *b, struct buyer_index *index, struct location *seller, int seller_position, int distance_from_current, 
+    int best_value, int *transaction_quantity);
+int get_best_value_for_seller(struct bot *b, struct buyer_index *index, struct location *seller, int seller_position, int distance_from_current, 
+    int best_value, int **transaction_quantity);
+int evaluate_dump(struct bot *b, struct location *dump, int distance_from_current, int cannot_afford_petrol, int buyers_quantity, int bot_quantity_total);
 int fuelcheck(struct bot *b, int distance_to_best_value);
 int best_petrol_distance(struct bot *b, struct location *location, int distance_to_location);
 int best_petrol_cost(struct bot *b, struct location *location, int distance_to_location);
@@ -19,6 +100,22 @@ int distance_to_final_sales(struct bot *b, struct location *location);
 int size_of_map(struct bot *b);
 int cargo_search(struct cargo *cargo, struct commodity *location_commodity);
 void cargo_capacity_check(struct bot *b, struct cargo *cargo, int *weight_remaining, int *volume_remaining);
+int cargo_quantity_total(struct cargo *cargo);
 int buyer_total_for_cargo(struct bot *b);
 int bots_on_location(struct location *location);
-
+struct buyer_index *build_buyer_index(struct bot *b);
+struct commodity_buyers *buyers_for_commodity(struct buyer_index *index, struct commodity *commodity);
+void free_buyer_index(struct buyer_index *index);
+struct world_snapshot *build_world_snapshot(struct bot *b);
+void free_world_snapshot(struct world_snapshot *world);
+void copy_world_snapshot(struct world_snapshot *copy, struct world_snapshot *world);
+void mark_snapshot_location(struct world_snapshot *world, int position);
+void reset_world_snapshot(struct world_snapshot *copy, struct world_snapshot *world);
+void choose_action_by_rollouts(struct bot *b, struct buyer_index *index, int *action, int *n, int best_value_quantity);
+int follow_trade_plan(struct bot *b, int *action, int *n);
+int start_trade_plan(struct bot *b, int best_value, int *action, int *n);
+void hypothetical_state_of_bot(const struct world_snapshot *world, int bot, struct hypothetical_state *state);
+int what_if_value(const struct world_snapshot *world, const struct hypothetical_state *state, int position, int best_value, int *transaction_quantity);
+int what_if_best_value(const struct world_snapshot *world, const struct hypothetical_state *state, int *best_position, int *best_value_quantity);
+void what_if_values(const struct world_snapshot *world, const struct hypothetical_state *state, const int *positions, int n_positions, int *values);
+void what_if_best_values(const struct world_snapshot *world, const struct hypothetical_state *states, int n_states, int *values, int *best_positions);
@@ -0,0 +1,304 @@
+/*
+This file contains the "what if" evaluations: the same buyer, seller and dump evaluations as "evaluations.c" and the same petrol cost rules as "fuel.c", but asking what a location would be worth to a hypothetical bot
+(any position, fuel, cash, cargo and turns left) in a world snapshot (see "world_snapshot.c") rather than to the real bot in the real world.
+Nothing here changes the snapshot or keeps any state of its own, so any number of threads can evaluate the same snapshot at once.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "trader_bot.h"
+#include "trader_header.h"
+
+//Length of the shortest route between 2 positions.
+static int ring_distance(const struct world_snapshot *world, int from, int to) {
+    int distance = abs(to - from);
+
+    if (distance > world->map_size / 2) {
+        distance = world->map_size - distance;
+    }
+    return distance;
+}
+
+
+//"evaluate_best_petrol_station" for a snapshot: returns the position of the most cost effective petrol station from "position" (or "position" itself if there is none) and its signed distance through "*petrol_distance".
+//As in "fuel.c", a petrol station is always its own best petrol station.
+static int what_if_petrol_station(const struct world_snapshot *world, int position, int distance_to_location, int fuel, int for_distance, int *petrol_distance) {
+    const struct snapshot_location *location = &world->locations[position];
+    int best_station = position;
+    int best_station_cost = 0;
+
+    *petrol_distance = 0;
+    if (location->type == LOCATION_PETROL_STATION) {
+        return position;
+    }
+
+    int first = 0;
+    while (first < world->n_petrol_stations && world->petrol_stations[first] < position) {    //stations are tried going forwards from "position", as "get_location_of_type" finds them, so that ties between equally cost effective stations go the same way
+        first++;
+    }
+
+    for (int counter = 0; counter < world->n_petrol_stations; counter++) {
+        int station = world->petrol_stations[(first + counter) % world->n_petrol_stations];
+        const struct snapshot_location *petrol_station = &world->locations[station];
+        int actual_distance_to_petrol = ring_distance(world, position, station);
+        int station_cost;
+
+        if (actual_distance_to_petrol >= petrol_station->quantity) {      //takes as much fuel to get there as can be bought there
+            continue;
+        }
+        if (petrol_station->quantity >= world->fuel_tank_capacity) {
+            station_cost = petrol_station->price * (actual_distance_to_petrol + distance_to_location);
+        } else {
+            station_cost = petrol_station->price * (actual_distance_to_petrol + distance_to_location) *
+                (world->fuel_tank_capacity / (petrol_station->quantity + 1));
+        }
+        if (actual_distance_to_petrol + distance_to_location > fuel && for_distance == TRUE) {
+            continue;
+        }
+
+        if (station_cost < best_station_cost || best_station_cost == 0) {
+            best_station_cost = station_cost;
+            best_station = station;
+            *petrol_distance = (station - position + world->map_size) % world->map_size <= world->map_size / 2 ?
+                actual_distance_to_petrol : -actual_distance_to_petrol;
+        }
+    }
+
+    return best_station;
+}
+
+
+//"best_petrol_distance" for a snapshot.
+static int what_if_petrol_distance(const struct world_snapshot *world, int position, int distance_to_location, int fuel) {
+    int petrol_distance;
+
+    what_if_petrol_station(world, position, distance_to_location, fuel, TRUE, &petrol_distance);
+    return petrol_distance;
+}
+
+
+//"best_petrol_cost" for a snapshot.
+static int what_if_petrol_cost(const struct world_snapshot *world, int position, int distance_to_location) {
+    int petrol_distance;
+    int station = what_if_petrol_station(world, position, distance_to_location, 0, FALSE, &petrol_distance);
+    const struct snapshot_location *petrol_station = &world->locations[station];
+
+    petrol_distance = abs(petrol_distance);
+    if (petrol_distance + distance_to_location == 0) {
+        return petrol_station->price;
+    } else if (petrol_station->quantity >= world->fuel_tank_capacity) {
+        return petrol_station->price * (petrol_distance + distance_to_location);
+    } else {
+        return petrol_station->price * (petrol_distance + distance_to_location) * (world->fuel_tank_capacity / (petrol_station->quantity + 1));
+    }
+}
+
+
+//"bots_on_location" for a hypothetical state: the snapshot bots at a position, leaving out the one the state was made from, plus the hypothetical bot itself.
+static int what_if_bots_on_location(const struct world_snapshot *world, const struct hypothetical_state *state, int position) {
+    int bot_counter = 1;
+
+    for (int counter = 0; counter < world->n_bots; counter++) {
+        if (counter != state->bot && world->bots[counter].position == position) {
+            bot_counter++;
+        }
+    }
+    return bot_counter;
+}
+
+
+//"evaluate_buyer" for a hypothetical state.
+static int what_if_buyer(const struct world_snapshot *world, const struct hypothetical_state *state, int position, int distance_from_current) {
+    const struct snapshot_location *buyer = &world->locations[position];
+
+    if (distance_from_current == 0 && what_if_bots_on_location(world, state, position) >= buyer->quantity) {
+        return 0;
+    }
+    if (buyer->commodity < 0 || state->cargo[buyer->commodity] <= 0) {
+        return 0;
+    }
+
+    int number_sold = state->cargo[buyer->commodity] < buyer->quantity ? state->cargo[buyer->commodity] : buyer->quantity;
+    return number_sold * buyer->price - what_if_petrol_cost(world, position, distance_from_current);
+}
+
+
+//"evaluate_seller" and "get_best_value_for_seller" for a hypothetical state, including the same pruning against "best_value".
+static int what_if_seller(const struct world_snapshot *world, const struct hypothetical_state *state, int position, int distance_from_current,
+    int best_value, int *transaction_quantity) {
+
+    const struct snapshot_location *seller = &world->locations[position];
+    int commodity = seller->commodity;
+    int weight_remaining = world->maximum_cargo_weight;
+    int volume_remaining = world->maximum_cargo_volume;
+    int best_value_for_seller = 0;
+
+    if (commodity < 0 || world->first_buyer[commodity] == world->first_buyer[commodity + 1]) {
+        return 0;
+    }
+
+    for (int counter = 0; counter < world->n_commodities; counter++) {
+        weight_remaining -= state->cargo[counter] * world->commodity_weight[counter];
+        volume_remaining -= state->cargo[counter] * world->commodity_volume[counter];
+    }
+    int max_transportable_quantity = weight_remaining / world->commodity_weight[commodity] < volume_remaining / world->commodity_volume[commodity] ?
+        weight_remaining / world->commodity_weight[commodity] : volume_remaining / world->commodity_volume[commodity];
+    if (max_transportable_quantity * seller->price > state->cash) {
+        max_transportable_quantity = state->cash / seller->price;
+    }
+    if (max_transportable_quantity > seller->quantity) {
+        max_transportable_quantity = seller->quantity;
+    }
+    *transaction_quantity = max_transportable_quantity;
+
+    for (int counter = world->first_buyer[commodity]; counter < world->first_buyer[commodity + 1]; counter++) {
+        int buyer_position = world->buyers[counter];
+        const struct snapshot_location *buyer = &world->locations[buyer_position];
+        int marginal_profit = buyer->price - seller->price;
+
+        if (marginal_profit * max_transportable_quantity <= best_value ||
+            (best_value_for_seller != 0 && marginal_profit * max_transportable_quantity <= best_value_for_seller)) {
+            break;
+        }
+
+        int distance_to_buyer = ring_distance(world, position, buyer_position);
+        int quantity_of_transaction = buyer->quantity < seller->quantity ? buyer->quantity : seller->quantity;
+        if (max_transportable_quantity < quantity_of_transaction) {
+            quantity_of_transaction = max_transportable_quantity;
+        }
+
+        int travel_cost = what_if_petrol_cost(world, position, distance_from_current + distance_to_buyer);
+        if (distance_from_current + distance_to_buyer + what_if_petrol_distance(world, buyer_position, distance_to_buyer, state->fuel) > state->fuel &&   //the petrol distance is signed, as in "get_best_value_for_seller"
+            travel_cost > state->cash - seller->price * quantity_of_transaction) {
+            continue;
+        }
+
+        int buyer_value = quantity_of_transaction * marginal_profit - travel_cost;
+        if (buyer_value > best_value_for_seller || best_value_for_seller == 0) {
+            best_value_for_seller = buyer_value;
+            *transaction_quantity = quantity_of_transaction;
+        }
+    }
+
+    return best_value_for_seller;
+}
+
+
+//"evaluate_dump" for a hypothetical state.
+static int what_if_dump(const struct world_snapshot *world, const struct hypothetical_state *state, int position, int distance_from_current) {
+    int buyers_quantity = 0;
+    int bot_quantity_total = 0;
+
+    for (int commodity = 0; commodity < world->n_commodities; commodity++) {
+        bot_quantity_total += state->cargo[commodity];
+        if (state->cargo[commodity] > 0) {
+            for (int counter = world->first_buyer[commodity]; counter < world->first_buyer[commodity + 1]; counter++) {
+                if (world->buyers[counter] != state->position) {      //as in "buyer_total_for_cargo", the bot's own location is not counted
+                    buyers_quantity += world->locations[world->buyers[counter]].quantity;
+                }
+            }
+        }
+    }
+    if (buyers_quantity > bot_quantity_total) {
+        return 0;
+    }
+
+    int price = world->locations[position].price;
+    for (int counter = 1; counter < world->map_size; counter++) {     //price of the closest buyer forwards for anything in cargo
+        const struct snapshot_location *closest_buyer = &world->locations[(position + counter) % world->map_size];
+        if (closest_buyer->type == LOCATION_BUYER && closest_buyer->commodity >= 0 && state->cargo[closest_buyer->commodity] > 0) {
+            price = closest_buyer->price;
+            break;
+        }
+    }
+
+    int quantity_dumped = bot_quantity_total - buyers_quantity;
+    return (quantity_dumped * price - what_if_petrol_cost(world, position, distance_from_current)) / 2;
+}
+
+
+//Fills "state" with the position, fuel, cash and cargo of one of the snapshot's bots and the snapshot's turns left.
+void hypothetical_state_of_bot(const struct world_snapshot *world, int bot, struct hypothetical_state *state) {
+    state->bot = bot;
+    state->position = world->bots[bot].position;
+    state->fuel = world->bots[bot].fuel;
+    state->cash = world->bots[bot].cash;
+    state->turns_left = world->turns_left;
+    memcpy(state->cargo, world->bots[bot].cargo, sizeof state->cargo);
+}
+
+
+//Value of the location at "position" to a bot in "state", as "scan_world" would value it. Sellers that cannot beat "best_value" are given 0 without looking at their buyers, pass 0 to only skip sellers that cannot make a profit.
+//For a seller, "*transaction_quantity" is set to how much should be bought.
+int what_if_value(const struct world_snapshot *world, const struct hypothetical_state *state, int position, int best_value, int *transaction_quantity) {
+    int type = world->locations[position].type;
+    int distance_from_current = ring_distance(world, state->position, position);
+
+    *transaction_quantity = 0;
+    if (type == LOCATION_BUYER) {
+        return what_if_buyer(world, state, position, distance_from_current);
+    } else if (type == LOCATION_SELLER && state->turns_left >= MIN_TURNS_TO_BUY_AND_SELL) {
+        return what_if_seller(world, state, position, distance_from_current, best_value, transaction_quantity);
+    } else if (type == LOCATION_DUMP && state->turns_left >= MIN_TURNS_TO_ACTION_THEN_MAKE_PROFIT) {
+        return what_if_dump(world, state, position, distance_from_current);
+    }
+    return 0;
+}
+
+
+//"scan_world" for a hypothetical state: returns the best value on the map and sets "*best_position" to where it is (the state's own position if nothing has a value above 0).
+//Locations are tried nearest first, forwards before backwards, so ties are broken the same way "scan_world" breaks them.
+int what_if_best_value(const struct world_snapshot *world, const struct hypothetical_state *state, int *best_position, int *best_value_quantity) {
+    int best_value = 0;
+    int transaction_quantity;
+
+    *best_position = state->position;
+    *best_value_quantity = 0;
+    for (int distance = 0; distance <= world->map_size / 2; distance++) {
+        int forwards = (state->position + distance) % world->map_size;
+        int backwards = (state->position - distance + world->map_size) % world->map_size;
+        int value = what_if_value(world, state, forwards, best_value, &transaction_quantity);
+
+        if (value > best_value) {
+            best_value = value;
+            *best_position = forwards;
+            *best_value_quantity = transaction_quantity;
+        }
+        if (backwards == forwards) {
+            continue;
+        }
+        value = what_if_value(world, state, backwards, best_value, &transaction_quantity);
+        if (value > best_value) {
+            best_value = value;
+            *best_position = backwards;
+            *best_value_quantity = transaction_quantity;
+        }
+    }
+    return best_value;
+}
+
+
+//Batch version of "what_if_value": values[i] is the value of positions[i] to a bot in "state".
+void what_if_values(const struct world_snapshot *world, const struct hypothetical_state *state, const int *positions, int n_positions, int *values) {
+    int transaction_quantity;
+
+    for (int counter = 0; counter < n_positions; counter++) {
+        values[counter] = what_if_value(world, state, positions[counter], 0, &transaction_quantity);
+    }
+}
+
+
+//Batch version of "what_if_best_value": scores every state in "states" against the same snapshot. "best_positions" may be NULL if only the values are wanted.
+void what_if_best_values(const struct world_snapshot *world, const struct hypothetical_state *states, int n_states, int *values, int *best_positions) {
+    int best_position;
+    int best_value_quantity;
+
+    for (int counter = 0; counter < n_states; counter++) {
+        values[counter] = what_if_best_value(world, &states[counter], &best_position, &best_value_quantity);
+        if (best_positions != NULL) {
+            best_positions[counter] = best_position;
+        }
+    }
+}
@@ -0,0 +1,220 @@
+/*
+This file contains the compact copy of the world used by the rollouts in "rollouts.c".
+The real world is a linked list of locations full of pointers, which is far too slow to copy thousands of times a turn. A snapshot stores every location as 4 ints in one array indexed by position (distance forwards from the bot's location),
+commodities as small integer ids and every bot as a fixed size value so that a rollout can copy the whole world with two memcpy calls, or undo its changes by restoring only the locations it traded at.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stddef.h>
+#include "trader_bot.h"
+#include "trader_header.h"
+
+//Returns the snapshot id of a commodity, adding it to the snapshot if it has not been seen yet. Returns -1 if there are more commodities than a snapshot can hold.
+static int snapshot_commodity_id(struct world_snapshot *world, struct commodity *commodity) {
+    for (int counter = 0; counter < world->n_commodities; counter++) {
+        if (world->commodities[counter] == commodity || strcmp(world->commodities[counter]->name, commodity->name) == 0) {
+            return counter;
+        }
+    }
+
+    if (world->n_commodities == MAX_SNAPSHOT_COMMODITIES) {
+        return -1;
+    }
+    world->commodities[world->n_commodities] = commodity;
+    world->max_buyer_price[world->n_commodities] = 0;
+    world->n_commodities++;
+    return world->n_commodities - 1;
+}
+
+
+//Copies a bot's position, fuel, cash and cargo into a snapshot bot. Returns FALSE if its cargo holds a commodity the snapshot has no room for.
+static int snapshot_bot(struct world_snapshot *world, struct bot *bot, int position, struct snapshot_bot *copy) {
+    memset(copy, 0, sizeof (struct snapshot_bot));
+    copy->position = position;
+    copy->fuel = bot->fuel;
+    copy->cash = bot->cash;
+
+    for (struct cargo *cargo = bot->cargo; cargo != NULL; cargo = cargo->next) {
+        int commodity = snapshot_commodity_id(world, cargo->commodity);
+        if (commodity < 0) {
+            return FALSE;
+        }
+        copy->cargo[commodity] += cargo->quantity;
+    }
+    return TRUE;
+}
+
+
+//qsort comparison for "index_world_snapshot": buyers grouped by commodity id, highest price first, then in map order.
+static int compare_snapshot_buyers(const void *first, const void *second) {
+    const struct snapshot_location *buyer_a = *(struct snapshot_location * const *)first;
+    const struct snapshot_location *buyer_b = *(struct snapshot_location * const *)second;
+
+    if (buyer_a->commodity != buyer_b->commodity) {
+        return buyer_a->commodity - buyer_b->commodity;
+    }
+    if (buyer_a->price != buyer_b->price) {
+        return buyer_b->price - buyer_a->price;
+    }
+    return buyer_a < buyer_b ? -1 : buyer_a > buyer_b;
+}
+
+
+//Lists the petrol stations and the buyers of each commodity (highest price first, as in "build_buyer_index") so that evaluating a snapshot never has to walk the whole map to find them.
+//Prices never change within a turn, so the lists stay valid for every copy of the snapshot.
+static void index_world_snapshot(struct world_snapshot *world) {
+    struct snapshot_location **buyers = malloc((world->map_size + 1) * sizeof (struct snapshot_location *));
+    int n_buyers = 0;
+
+    world->petrol_stations = malloc((world->map_size + 1) * sizeof (int));
+    world->buyers = malloc((world->map_size + 1) * sizeof (int));
+    world->n_petrol_stations = 0;
+    assert(buyers != NULL && world->petrol_stations != NULL && world->buyers != NULL);
+
+    for (int position = 0; position < world->map_size; position++) {
+        if (world->locations[position].type == LOCATION_PETROL_STATION) {
+            world->petrol_stations[world->n_petrol_stations] = position;
+            world->n_petrol_stations++;
+        } else if (world->locations[position].type == LOCATION_BUYER && world->locations[position].commodity >= 0) {
+            buyers[n_buyers] = &world->locations[position];
+            n_buyers++;
+        }
+    }
+
+    qsort(buyers, n_buyers, sizeof (struct snapshot_location *), compare_snapshot_buyers);
+
+    int commodity = 0;
+    for (int counter = 0; counter < n_buyers; counter++) {
+        while (commodity <= buyers[counter]->commodity) {
+            world->first_buyer[commodity] = counter;
+            commodity++;
+        }
+        world->buyers[counter] = buyers[counter] - world->locations;
+    }
+    while (commodity <= MAX_SNAPSHOT_COMMODITIES) {
+        world->first_buyer[commodity] = n_buyers;
+        commodity++;
+    }
+
+    free(buyers);
+}
+
+
+//Builds a snapshot of the world as seen by bot "b" at the start of its turn. Bot 0 of the snapshot is always "b", every other bot found on the map follows.
+//Returns NULL if the world does not fit in a snapshot (too many commodities or bots), in which case the caller should just skip whatever it wanted the snapshot for.
+struct world_snapshot *build_world_snapshot(struct bot *b) {
+    struct world_snapshot *world = malloc(sizeof (struct world_snapshot));
+    struct location *current = b->location;
+    int position = 0;
+    int fits = TRUE;
+
+    assert(world != NULL);
+    world->map_size = size_of_map(b);
+    world->n_commodities = 0;
+    world->n_bots = 1;
+    world->n_changed = 0;
+    world->turns_left = b->turns_left;
+    world->fuel_tank_capacity = b->fuel_tank_capacity;
+    world->maximum_move = b->maximum_move;
+    world->maximum_cargo_weight = b->maximum_cargo_weight;
+    world->maximum_cargo_volume = b->maximum_cargo_volume;
+    world->locations = malloc(world->map_size * sizeof (struct snapshot_location));
+    assert(world->locations != NULL);
+
+    do {
+        struct snapshot_location *location = &world->locations[position];
+        location->type = current->type;
+        location->price = current->price;
+        location->quantity = current->quantity;
+        location->commodity = -1;
+
+        if ((current->type == LOCATION_BUYER || current->type == LOCATION_SELLER) && current->commodity != NULL) {
+            location->commodity = snapshot_commodity_id(world, current->commodity);
+            if (location->commodity < 0) {
+                fits = FALSE;
+            } else if (current->type == LOCATION_BUYER && current->price > world->max_buyer_price[location->commodity]) {
+                world->max_buyer_price[location->commodity] = current->price;
+            }
+        }
+
+        for (struct bot_list *bots = current->bots; bots != NULL && fits == TRUE; bots = bots->next) {  //every bot other than "b" is recorded where it stands
+            if (bots->bot == b) {
+                continue;
+            }
+            if (world->n_bots == MAX_SNAPSHOT_BOTS) {
+                fits = FALSE;
+            } else if (snapshot_bot(world, bots->bot, position, &world->bots[world->n_bots]) == TRUE) {
+                world->n_bots++;
+            } else {
+                fits = FALSE;
+            }
+        }
+
+        current = current->next;
+        position++;
+    } while (current != b->location && fits == TRUE);
+
+    world->petrol_stations = NULL;
+    world->buyers = NULL;
+    if (fits == FALSE || snapshot_bot(world, b, 0, &world->bots[0]) == FALSE) {
+        free_world_snapshot(world);
+        return NULL;
+    }
+
+    for (int counter = 0; counter < world->n_commodities; counter++) {        //weight and volume are copied out so a rollout never has to follow a pointer
+        world->commodity_weight[counter] = world->commodities[counter]->weight;
+        world->commodity_volume[counter] = world->commodities[counter]->volume;
+    }
+
+    index_world_snapshot(world);
+    return world;
+}
+
+
+void free_world_snapshot(struct world_snapshot *world) {
+    free(world->petrol_stations);
+    free(world->buyers);
+    free(world->locations);
+    free(world);
+}
+
+
+//Copies "world" into "copy", whose locations array must already have room for "world->map_size" locations.
+void copy_world_snapshot(struct world_snapshot *copy, struct world_snapshot *world) {
+    struct snapshot_location *locations = copy->locations;
+
+    memcpy(copy, world, sizeof (struct world_snapshot));
+    copy->locations = locations;
+    copy->n_changed = 0;
+    memcpy(copy->locations, world->locations, world->map_size * sizeof (struct snapshot_location));
+}
+
+
+//Records that a location of a copy is about to be changed so that "reset_world_snapshot" knows to restore it.
+void mark_snapshot_location(struct world_snapshot *world, int position) {
+    if (world->n_changed >= 0 && world->n_changed < MAX_SNAPSHOT_CHANGES) {
+        world->changed[world->n_changed] = position;
+        world->n_changed++;
+    } else {
+        world->n_changed = -1;                  //too many changes to remember, the next reset copies the whole world
+    }
+}
+
+
+//Turns a copy made by "copy_world_snapshot" back into "world". Only the locations marked as changed are copied back, so on a large map this is far cheaper than copying every location again for each rollout.
+void reset_world_snapshot(struct world_snapshot *copy, struct world_snapshot *world) {
+    struct snapshot_location *locations = copy->locations;
+
+    if (copy->n_changed < 0) {
+        copy_world_snapshot(copy, world);
+        return;
+    }
+    for (int counter = 0; counter < copy->n_changed; counter++) {
+        locations[copy->changed[counter]] = world->locations[copy->changed[counter]];
+    }
+    memcpy(copy, world, offsetof(struct world_snapshot, n_changed));    //everything but the change list and locations, which come last
+    copy->n_changed = 0;
+}